@@ -11,64 +11,285 @@ namespace basis_spline {
 //                       x - t(i)               t(i+k+1) - x
 //     B(i,k+1)(x)  =  ----------- B(i,k)(x) + --------------- B(i+1,k)(x)
 //                     t(i+k)-t(i)             t(i+k+1)-t(i+1)
-	
+
+	// largest order for stack allocated basis spline values
+	static const size_t max_order = 24;
+
+	// index mu with t[mu] <= x < t[mu+1], or n if x is not in [t[0], t[n-1])
+	template<class T, class U>
+	inline size_t interval(size_t n, const U* t, T x)
+	{
+		if (n < 2 || x < t[0] || !(x < t[n - 1]))
+			return n;
+
+		return std::upper_bound(t, t + n, x) - t - 1;
+	}
+
+	// Cox-de Boor triangular scheme for all order k basis splines that are nonzero at x.
+	// Sets B[r] = B(mu - k + r, k)(x), r = 0,...,k, where t[mu] <= x < t[mu+1].
+	// Basis splines that need knots outside of t are set to 0.
+	template<class T, class U>
+	inline void values(size_t k, size_t n, const U* t, size_t mu, T x, T* B)
+	{
+		B[0] = 1;
+
+		for (size_t j = 1; j <= k; ++j) {
+			T saved(0);
+
+			// B[r] = B(l, j-1) for l = mu + 1 + r - j contributes to B(l-1, j) and B(l, j)
+			for (size_t r = 0; r < j; ++r) {
+				if (mu + 1 + r >= j && mu + 1 + r < n) {
+					const U* tl = t + (mu + 1 + r - j);
+					T temp(0);
+
+					if (tl[j] != tl[0])
+						temp = B[r]/(tl[j] - tl[0]);
+					B[r] = saved + (tl[j] - x)*temp;
+					saved = (x - tl[0])*temp;
+				}
+				else {
+					B[r] = saved;
+					saved = 0;
+				}
+			}
+			B[j] = saved;
+
+			for (size_t r = 0; r <= j; ++r) {
+				if (mu + r < j || mu + r + 2 > n)
+					B[r] = 0;
+			}
+		}
+	}
+
+	// values() for m points x in [t[mu], t[mu+1]) with B[r*ld + p] = B(mu - k + r, k)(x[p]).
+	// The point loop is innermost so it vectorizes. B needs room for k + 1 rows.
+	template<class T, class U>
+	inline void values(size_t k, size_t n, const U* t, size_t mu, size_t m, const T* x, T* B, size_t ld)
+	{
+		for (size_t p = 0; p < m; ++p)
+			B[p] = 1;
+
+		for (size_t j = 1; j <= k; ++j) {
+			// row j holds the saved term
+			T* Bj = B + j*ld;
+			for (size_t p = 0; p < m; ++p)
+				Bj[p] = 0;
+
+			for (size_t r = 0; r < j; ++r) {
+				T* Br = B + r*ld;
+
+				if (mu + 1 + r >= j && mu + 1 + r < n) {
+					const U* tl = t + (mu + 1 + r - j);
+					T t0 = static_cast<T>(tl[0]), tj = static_cast<T>(tl[j]);
+					T dt = tj != t0 ? 1/(tj - t0) : T(0);
+
+					for (size_t p = 0; p < m; ++p) {
+						T temp = Br[p]*dt;
+						Br[p] = Bj[p] + (tj - x[p])*temp;
+						Bj[p] = (x[p] - t0)*temp;
+					}
+				}
+				else {
+					for (size_t p = 0; p < m; ++p) {
+						Br[p] = Bj[p];
+						Bj[p] = 0;
+					}
+				}
+			}
+
+			for (size_t r = 0; r <= j; ++r) {
+				if (mu + r < j || mu + r + 2 > n) {
+					T* Br = B + r*ld;
+					for (size_t p = 0; p < m; ++p)
+						Br[p] = 0;
+				}
+			}
+		}
+	}
+
+	// sum of B[r] from values() for order k. The basis splines at the right end that would
+	// need knots past t[n-1] are missing, so use the partition of unity when they matter.
+	template<class T>
+	inline T sum(size_t k, size_t n, size_t mu, const T* B)
+	{
+		if (mu + k + 1 >= n && mu >= k)
+			return T(1);
+
+		T s(0);
+		for (size_t r = 0; r <= k; ++r)
+			s += B[r];
+
+		return s;
+	}
+
 	// right continuous i-th basis spline of order k having n knot points t
 	template<class T, class U>
 	inline std::function<T(size_t,T)> value(size_t k, size_t n, const U* t)
 	{
-		if (k == 0) { // order 0 - piecewise constant
-			return [n,t](size_t i, T x) -> T { 
-				ensure (i + 1 < n);
-			
-				return 1*(t[i] <= x && x < t[i + 1]); 
-			};
-		}
+		ensure (k <= max_order);
 
-		return [k,n,t](size_t i, T x) -> T 
+		return [k,n,t](size_t i, T x) -> T
 		{
 			ensure (i + k + 1 < n);
 
 			if (x < t[i] || x >= t[i + k + 1])
 				return 0;
 
-			auto B = value<T,U>(k - 1, n, t);
-			T b  = B(i, x);
-			T b_ = B(i + 1, x);
-			T dt  = static_cast<T>(t[i + k] - t[i]);
-			T dt_ = static_cast<T>(t[i + k + 1] - t[i + 1]);
-			T b_dt = dt ? b/dt : 0;
-			T b_dt_ = dt_ ? b_/dt_ : 0;
+			T B[max_order + 1];
+			size_t mu = interval(n, t, x);
+			values(k, n, t, mu, x, B);
 
-			return (x - t[i])*b_dt + (t[i + k + 1] - x)*b_dt_;
+			return B[i + k - mu];
 		};
 	}
 
 	template<class T, class U>
 	inline std::function<T(size_t,T)> derivative(size_t k, size_t n, const U* t)
 	{
+		ensure (k <= max_order);
+
 		return [k,n,t](size_t i, T x) -> T
 		{
-			auto B =value<T,U>(k - 1, n, t);
+			ensure (i + k + 1 < n);
 
-			return k*B(i, x)/(t[i + k] - t[i]) - k*B(i + 1, x)/(t[i + k + 1] - t[i + 1]);
+			if (k == 0 || x < t[i] || x >= t[i + k + 1])
+				return 0;
+
+			// B(i,k-1) and B(i+1,k-1)
+			T B[max_order + 1];
+			size_t mu = interval(n, t, x);
+			values(k - 1, n, t, mu, x, B);
+
+			T b  = mu <= i + k - 1 ? B[i + k - 1 - mu] : 0;
+			T b_ = mu >= i + 1 ? B[i + k - mu] : 0;
+			T dt  = static_cast<T>(t[i + k] - t[i]);
+			T dt_ = static_cast<T>(t[i + k + 1] - t[i + 1]);
+
+			return (dt ? k*b/dt : 0) - (dt_ ? k*b_/dt_ : 0);
 		};
 	}
 
 	template<class T, class U>
 	inline std::function<T(size_t,T)> integral(size_t k, size_t n, const U* t)
 	{
-		return [k,n,t](size_t i, T x) -> T 
+		ensure (k + 1 <= max_order);
+
+		return [k,n,t](size_t i, T x) -> T
 		{
 			T I(0);
 
-			auto B = value<T,U>(k + 1, n, t);
+			size_t mu = interval(n, t, x);
+			if (mu == n)
+				return I;
 
-			for (size_t j = i; j + k + 2 < n; ++j)
-				I += B(j, x);
+			// sum of B(j,k+1)(x) for j >= i
+			T B[max_order + 1];
+			values(k + 1, n, t, mu, x, B);
+			I = sum(k + 1, n, mu, B);
+			for (size_t r = 0; r <= k + 1 && mu + r < i + k + 1; ++r)
+				I -= B[r];
 
 			return I*(t[i + k + 1] - t[i])/(k + 1);
 		};
 	}
 
+	namespace detail {
+
+		// term r = R - 1 of the step from order J - 1 to J for interior knot spans
+		template<size_t J, size_t R>
+		struct de_boor_term {
+			template<class T, class U>
+			static void apply(const U* t, size_t mu, T x, T* B, T& saved)
+			{
+				de_boor_term<J,R-1>::apply(t, mu, x, B, saved);
+
+				const U* tl = t + (mu + R - J);
+				T temp(0);
+
+				if (tl[J] != tl[0])
+					temp = B[R - 1]/(tl[J] - tl[0]);
+				B[R - 1] = saved + (tl[J] - x)*temp;
+				saved = (x - tl[0])*temp;
+			}
+		};
+		template<size_t J>
+		struct de_boor_term<J,0> {
+			template<class T, class U>
+			static void apply(const U*, size_t, T, T*, T&)
+			{ }
+		};
+
+		// B[r] = B(mu - J + r, J)(x), r = 0,...,J
+		template<size_t J>
+		struct de_boor_step {
+			template<class T, class U>
+			static void apply(const U* t, size_t mu, T x, T* B)
+			{
+				de_boor_step<J-1>::apply(t, mu, x, B);
+
+				T saved(0);
+				de_boor_term<J,J>::apply(t, mu, x, B, saved);
+				B[J] = saved;
+			}
+		};
+		template<>
+		struct de_boor_step<0> {
+			template<class T, class U>
+			static void apply(const U*, size_t, T, T* B)
+			{
+				B[0] = 1;
+			}
+		};
+
+	} // namespace detail
+
 } // namespace basis_spline
+
+	// basis splines of fixed order K with the Cox-de Boor recurrence unrolled at compile time
+	template<class U, size_t K>
+	class basis_spline_struct {
+		size_t n_;
+		const U* t_;
+	public:
+		static const size_t order = K;
+
+		basis_spline_struct(size_t n, const U* t)
+			: n_(n), t_(t)
+		{
+			ensure (n_ > K + 1);
+		}
+
+		size_t size(void) const
+		{
+			return n_;
+		}
+		const U* knots(void) const
+		{
+			return t_;
+		}
+
+		// index mu with t[mu] <= x < t[mu+1], or n if x is not in [t[0], t[n-1])
+		template<class T>
+		size_t interval(T x) const
+		{
+			return basis_spline::interval(n_, t_, x);
+		}
+
+		// B[r] = B(mu - J + r, J)(x), r = 0,...,J
+		template<size_t J, class T>
+		void values(size_t mu, T x, T* B) const
+		{
+			// no knots outside of t needed
+			if (mu >= J && mu + J + 2 <= n_)
+				basis_spline::detail::de_boor_step<J>::apply(t_, mu, x, B);
+			else
+				basis_spline::values(J, n_, t_, mu, x, B);
+		}
+		template<class T>
+		void values(size_t mu, T x, T* B) const
+		{
+			values<K>(mu, x, B);
+		}
+	};
+
 } // namespace curve
@@ -18,14 +18,79 @@ Piecewise-flat forward curves are modeled by arrays t and f, and an extrapolated
 Note f(t[i]) = f[i], unlike for order 0 basis splines, and f is left continuous.
 */
 #include <algorithm>
+#include <vector>
 #include "../include/ensure.h"
+#include "../numerical/exp.h"
 #include "../numerical/newton.h"
 
 namespace curves {
 namespace pwflat {
 
+	namespace detail {
+
+		// cash flows discounted per call to numerical::exp
+		static const size_t chunk = 64;
+
+		// present value of cash flows c[j] at times u[j], j < m, continuing from cursor s of curve f
+		template<class C, class T, class F>
+		inline F present_value(const C& f, typename C::cursor& s, size_t m, const T* u, const F* c)
+		{
+			F pv(0);
+			F D[chunk];
+
+			for (size_t j = 0; j < m; j += chunk) {
+				size_t n = std::min(chunk, m - j);
+
+				f.discount(n, u + j, D, s);
+				for (size_t k = 0; k < n; ++k)
+					pv += c[j + k]*D[k];
+			}
+
+			return pv;
+		}
+		template<class C, class T, class F>
+		inline F present_value(const C& f, size_t m, const T* u, const F* c)
+		{
+			typename C::cursor s = typename C::cursor();
+
+			return present_value(f, s, m, u, c);
+		}
+		// present values pv[k] of instruments k < l having m[k] cash flows
+		template<class C, class T, class F>
+		inline void present_value(const C& f, size_t l, const size_t* m, const T* u, const F* c, F* pv)
+		{
+			typename C::cursor s = typename C::cursor();
+
+			for (size_t k = 0; k < l; ++k) {
+				pv[k] = present_value(f, s, m[k], u, c);
+				u += m[k];
+				c += m[k];
+			}
+		}
+		// parallel shift of sorted cash flows past u0
+		template<class C, class T, class F>
+		inline F duration(const C& f, size_t m, const T* u, const F* c, T u0)
+		{
+			F dur(0);
+			F D[chunk];
+			typename C::cursor s = typename C::cursor();
+
+			for (size_t j = std::lower_bound(u, u + m, u0) - u; j < m; j += chunk) { // u0 <= u[j]
+				size_t n = std::min(chunk, m - j);
+
+				f.discount(n, u + j, D, s);
+				for (size_t k = 0; k < n; ++k)
+					dur += (u[j + k] - u0)*c[j + k]*D[k];
+			}
+
+			return -dur;
+		}
+
+	} // namespace detail
+
 	template<class T = double, class F = double>
 	class forward {
+	protected:
 		size_t n_;
 		const T* t_;
 		const F* f_;
@@ -90,39 +155,102 @@ namespace pwflat {
 
 			return I;
 		}
+		// integral to u given the integral I to t0 = t[i-1] for a previous u
+		// Advances i, t0, and I so increasing u make a single pass over the knots.
+		F integral(T u, size_t& i, T& t0, F& I) const
+		{
+			if (u < t0) {
+				// start over
+				i = 0;
+				t0 = 0;
+				I = 0;
+			}
+
+			for (; i < n_ && t_[i] < u; ++i) {
+				I += f_[i]*(t_[i] - t0);
+				t0 = t_[i];
+			}
+
+			return I + static_cast<F>((i == n_ ? _f_ : f_[i])*(u - t0));
+		}
 		F discount(T t) const
 		{
 			return exp(-integral(t));
 		}
+		// position in the knots after the last time discounted
+		struct cursor {
+			size_t i;
+			T t0;
+			F I;
+		};
+		// discount D[j] at times u[j], j < m, continuing from cursor s
+		// Sorted times are merged against the knots in one pass.
+		void discount(size_t m, const T* u, F* D, cursor& s) const
+		{
+			for (size_t j = 0; j < m; ++j)
+				D[j] = -integral(u[j], s.i, s.t0, s.I);
+
+			numerical::exp(m, D, D);
+		}
+		void discount(size_t m, const T* u, F* D) const
+		{
+			cursor s = cursor();
+
+			discount(m, u, D, s);
+		}
 		F spot(T t)
 		{
 			return 1 == t + 1 ? value(t) : integral(t)/t;
 		}
-		F present_value(size_t m, const T* u, const F* c)
+		F present_value(size_t m, const T* u, const F* c) const
 		{
-			F pv(0);
+			return detail::present_value(*this, m, u, c);
+		}
+		// present values pv[k] of instruments k < l having m[k] cash flows
+		// Times u and cash flows c of each instrument follow the previous one.
+		void present_value(size_t l, const size_t* m, const T* u, const F* c, F* pv) const
+		{
+			detail::present_value(*this, l, m, u, c, pv);
+		}
+		// present value of sorted cash flows and its adjoint
+		// df[i] += w d(pv)/d(f[i]) for i < n and df[n] += w d(pv)/d(_f)
+		// computed in one forward sweep over the knots.
+		// Segment i = (t[i-1], t[i]] contributes (t[i] - t[i-1]) times the present value
+		// of the cash flows past it, which is pv less the flows up to t[i].
+		F present_value_adjoint(size_t m, const T* u, const F* c, F* df, F w = 1) const
+		{
+			F pv(0); // present value of the cash flows so far
+			F v[detail::chunk];
+			cursor s = cursor();
+			size_t i = 0; // segment of u[j]
+
+			for (size_t j0 = 0; j0 < m; j0 += detail::chunk) {
+				size_t n = std::min(detail::chunk, m - j0);
+
+				discount(n, u + j0, v, s);
+				for (size_t j = j0; j < j0 + n; ++j) {
+					ensure (j == 0 || u[j - 1] <= u[j]);
+					for (; i < n_ && t_[i] < u[j]; ++i)
+						df[i] += w*pv*(t_[i] - (i ? t_[i - 1] : 0));
 
-			for (size_t i = 0; i < m; ++i) {
-				pv += c[i] * discount(u[i]);
+					F vj = c[j]*v[j - j0];
+					df[i] -= w*vj*(u[j] - (i ? t_[i - 1] : 0));
+					pv += vj;
+				}
 			}
+			// segments before the last cash flow
+			while (i-- > 0)
+				df[i] -= w*pv*(t_[i] - (i ? t_[i - 1] : 0));
 
 			return pv;
 		}
 		// parallel shift past u0
-		F duration(size_t m, const T* u, const T* c, T u0 = 0)
+		F duration(size_t m, const T* u, const F* c, T u0 = 0) const
 		{
-			T dur(0);
-
-			const T* ui = std::lower_bound(u, u + m, u0); // u0 <= *ui
-
-			for (size_t i = ui - u; i < m; ++i) {
-				dur += (u[i] - u0) * c[i] * discount(u[i]);
-			}
-
-			return -dur;
+			return detail::duration(*this, m, u, c, u0);
 		}
 		// cash deposit
-		T bootstrap1(T u, F c) const
+		F bootstrap1(T u, F c) const
 		{
 			ensure (u > 0);
 			ensure (c > 0);
@@ -133,25 +261,25 @@ namespace pwflat {
 			return log(c*D0)/(u - t0);
 		}
 		// forward rate agreement
-		T bootstrap2(T u0, F c0, T u1, F c1)
+		F bootstrap2(T u0, F c0, T u1, F c1)
 		{
 			F _f;
 			T t0 = n_ ? t_[n_ - 1] : 0;
 			F D0 = discount(t0);
-			T d = -c1/c0; // works if c0 != -1
+			F d = -c1/c0; // works if c0 != -1
 
 			if (u0 < t0) { // overlap or cash deposit
-				T Dm = discount(u1);
-				_f = static_cast<T>(log(d*D0/Dm)/(u1 - u0));
+				F Dm = discount(u1);
+				_f = static_cast<F>(log(d*D0/Dm)/(u1 - u0));
 			}
 			else { // underlap
-				_f = static_cast<T>(log(d)/(u1 - t0));
+				_f = static_cast<F>(log(d)/(u1 - t0));
 			}
 
 			return _f;
 		}
 		// bootstrap arbitrary cash flows having price p
-		inline T bootstrap(size_t m, const T* u, const F* c, T p = 0)
+		inline F bootstrap(size_t m, const T* u, const F* c, F p = 0)
 		{
 			ensure (m && (n_ == 0 || u[m-1] > t_[n_-1]));
 
@@ -183,5 +311,102 @@ namespace pwflat {
 		}
 	};
 
+	// forward curve with cumulative integrals at each knot
+	//	I[i] = f[0] t[0] + f[1] (t[1] - t[0]) + ... + f[i] (t[i] - t[i-1])
+	// so integral(t) is a binary search and one multiply.
+	// Knots and forwards must not change during the lifetime of the cache.
+	template<class T = double, class F = double>
+	class cached_forward : public forward<T,F> {
+		std::vector<F> I_;
+	public:
+		cached_forward(size_t n = 0, const T* t = 0, const F* f = 0, F _f = 0)
+			: forward<T,F>(n, t, f, _f), I_(n)
+		{
+			F I(0);
+			T t0 = 0;
+
+			for (size_t i = 0; i < n; ++i) {
+				I += f[i]*(t[i] - t0);
+				I_[i] = I;
+				t0 = t[i];
+			}
+		}
+		cached_forward& extrapolate(F _f)
+		{
+			forward<T,F>::extrapolate(_f);
+
+			return *this;
+		}
+		F extrapolate(void) const
+		{
+			return forward<T,F>::extrapolate();
+		}
+		// integral from 0 to t[i]
+		F cumulative(size_t i) const
+		{
+			return I_[i];
+		}
+		// integral to u given index i of the knot interval of a previous u
+		F integral(T u, size_t& i) const
+		{
+			if (i > 0 && u <= this->t_[i - 1])
+				i = std::lower_bound(this->t_, this->t_ + i, u) - this->t_;
+
+			while (i < this->n_ && this->t_[i] < u)
+				++i;
+
+			if (i == 0)
+				return static_cast<F>((this->n_ ? this->f_[0] : this->_f_)*u);
+
+			return I_[i - 1] + static_cast<F>((i == this->n_ ? this->_f_ : this->f_[i])*(u - this->t_[i - 1]));
+		}
+		F integral(T t) const
+		{
+			size_t i = std::lower_bound(this->t_, this->t_ + this->n_, t) - this->t_; // t <= t[i]
+
+			return integral(t, i);
+		}
+		F discount(T t) const
+		{
+			return exp(-integral(t));
+		}
+		// index of the knot interval of the last time discounted
+		struct cursor {
+			size_t i;
+		};
+		// discount D[j] at times u[j], j < m, continuing from cursor s
+		void discount(size_t m, const T* u, F* D, cursor& s) const
+		{
+			for (size_t j = 0; j < m; ++j)
+				D[j] = -integral(u[j], s.i);
+
+			numerical::exp(m, D, D);
+		}
+		void discount(size_t m, const T* u, F* D) const
+		{
+			cursor s = cursor();
+
+			discount(m, u, D, s);
+		}
+		F spot(T t) const
+		{
+			return 1 == t + 1 ? this->value(t) : integral(t)/t;
+		}
+		F present_value(size_t m, const T* u, const F* c) const
+		{
+			return detail::present_value(*this, m, u, c);
+		}
+		// present values pv[k] of instruments k < l having m[k] cash flows
+		void present_value(size_t l, const size_t* m, const T* u, const F* c, F* pv) const
+		{
+			detail::present_value(*this, l, m, u, c, pv);
+		}
+		// parallel shift past u0
+		F duration(size_t m, const T* u, const F* c, T u0 = 0) const
+		{
+			return detail::duration(*this, m, u, c, u0);
+		}
+	};
+
 } // namespace pwflat
 } // namespace curves
\ No newline at end of file
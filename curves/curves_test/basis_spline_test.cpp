@@ -1,10 +1,80 @@
 // basis_spline_test.cpp
+#include <cmath>
+#include <limits>
+#include "../../include/ensure.h"
 #include "../../numerical/ulp.h"
 #include "../basis_spline.h"
 
 using namespace numerical;
 using namespace curves::basis_spline;
 
+template<class T>
+void basis_spline_values_test_(void)
+{
+	// uniform knots
+	T t[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	size_t n = sizeof(t)/sizeof(*t);
+
+	// partition of unity on [t[k], t[n-k-1])
+	for (size_t k = 0; k <= 4; ++k) {
+		for (T x = t[k]; x < t[n - k - 1]; x += T(0.125)) {
+			T B[max_order + 1];
+			size_t mu = interval(n, t, x);
+			values(k, n, t, mu, x, B);
+
+			T s(0);
+			for (size_t r = 0; r <= k; ++r)
+				s += B[r];
+			ensure (std::fabs(s - 1) < 4*std::numeric_limits<T>::epsilon());
+		}
+	}
+
+	// uniform cubic at knots is 1/6, 4/6, 1/6
+	auto B3 = value<T,T>(3, n, t);
+	ensure (B3(2, 2) == 0);
+	ensure (std::fabs(B3(2, 3) - T(1)/6) < 4*std::numeric_limits<T>::epsilon());
+	ensure (std::fabs(B3(2, 4) - T(4)/6) < 4*std::numeric_limits<T>::epsilon());
+	ensure (std::fabs(B3(2, 5) - T(1)/6) < 4*std::numeric_limits<T>::epsilon());
+	ensure (B3(2, 6) == 0);
+
+	// outside of the knots
+	ensure (interval(n, t, T(-1)) == n);
+	ensure (interval(n, t, t[n - 1]) == n);
+}
+
+template<class T>
+void basis_spline_derivative_test_(void)
+{
+	T t[] = {0, 0.5, 1, 2, 2.5, 4, 5, 7, 8};
+	size_t n = sizeof(t)/sizeof(*t);
+	T h = T(1e-5);
+
+	for (size_t k = 1; k <= 3; ++k) {
+		auto B = value<T,T>(k, n, t);
+		auto dB = derivative<T,T>(k, n, t);
+		auto IB = integral<T,T>(k, n, t);
+
+		for (size_t i = 0; i + k + 1 < n; ++i) {
+			// points inside each knot interval of the support
+			for (size_t j = i; j <= i + k; ++j) {
+				for (T s = T(0.2); s < 1; s += T(0.3)) {
+					T x = t[j] + s*(t[j + 1] - t[j]);
+					T df = (B(i, x + h) - B(i, x - h))/(2*h);
+					ensure (std::fabs(dB(i, x) - df) < 1e-6);
+
+					T dI = (IB(i, x + h) - IB(i, x - h))/(2*h);
+					ensure (std::fabs(B(i, x) - dI) < 1e-6);
+				}
+			}
+			// integral of B(i,k) is (t[i+k+1] - t[i])/(k+1)
+			if (i + k + 2 < n)
+				ensure (std::fabs(IB(i, t[i + k + 1]) - (t[i + k + 1] - t[i])/(k + 1)) < 1e-12);
+		}
+	}
+}
+
 void curves_basis_spline_test(void)
 {
-}
\ No newline at end of file
+	basis_spline_values_test_<double>();
+	basis_spline_derivative_test_<double>();
+}
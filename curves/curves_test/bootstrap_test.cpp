@@ -1,5 +1,6 @@
 // bootstrap_test.cpp
 #include <vector>
+#include "../../numerical/dual.h"
 #include "../bootstrap.h"
 
 using namespace curves::pwflat;
@@ -101,6 +102,116 @@ void forward_integral(void)
 	ensure (fabs(f[0] + f[1] + f[2] + .4*.5 - F.integral(3.5)) < eps);
 }
 
+template<class T, class U>
+void cached_forward_integral(void)
+{
+	U eps = std::numeric_limits<U>::epsilon();
+
+	T t[] = {1,2,3};
+	U f[] = {.1,.2,.3};
+	size_t n = dimof(t);
+
+	forward<T,U> F(n, t, f, .4);
+	cached_forward<T,U> G(n, t, f, .4);
+
+	ensure (G.size() == n);
+	ensure (G.cumulative(0) == f[0]);
+	ensure (fabs(G.cumulative(2) - (f[0] + f[1] + f[2])) < eps);
+
+	for (T u = -1; u <= 5; u += .25) {
+		ensure (fabs(F.integral(u) - G.integral(u)) < 4*eps);
+		ensure (fabs(F.discount(u) - G.discount(u)) < 4*eps);
+	}
+
+	G.extrapolate(.5);
+	ensure (fabs(f[0] + f[1] + f[2] + .5*.5 - G.integral(3.5)) < 4*eps);
+
+	cached_forward<T,U> H;
+	H.extrapolate(.5);
+	ensure (H.integral(2) == 1);
+}
+
+template<class T, class U, class F>
+void forward_batch_(const F& f)
+{
+	U eps = std::numeric_limits<U>::epsilon();
+
+	// sorted, repeated, and out of order times
+	T u[] = {-.5, 0, .5, 1, 1, 1.5, 2.5, 3, 3.5, 4, 0.25, 2, 5};
+	size_t m = dimof(u);
+	U D[dimof(u)];
+
+	f.discount(m, u, D);
+	for (size_t j = 0; j < m; ++j)
+		ensure (fabs(D[j] - f.discount(u[j])) < 4*eps);
+
+	// two instruments back to back
+	size_t mk[] = {4, 3};
+	T v[] = {0, 1, 2, 3,  .5, 1.5, 2.5};
+	U c[] = {-1, .1, .1, 1.1,  -1, .05, 1.05};
+	U pv[2];
+
+	f.present_value(2, mk, v, c, pv);
+	ensure (fabs(pv[0] - f.present_value(4, v, c)) < 4*eps);
+	ensure (fabs(pv[1] - f.present_value(3, v + 4, c + 4)) < 4*eps);
+
+	U pv0(0);
+	for (size_t j = 0; j < 4; ++j)
+		pv0 += c[j]*f.discount(v[j]);
+	ensure (fabs(pv[0] - pv0) < 4*eps);
+
+	// more cash flows than are discounted at once
+	std::vector<T> w(150);
+	std::vector<U> cw(w.size());
+	for (size_t j = 0; j < w.size(); ++j) {
+		w[j] = static_cast<T>(j)/30;
+		cw[j] = 1 + static_cast<U>(j%7);
+	}
+	U pvw(0), durw(0);
+	for (size_t j = 0; j < w.size(); ++j) {
+		pvw += cw[j]*f.discount(w[j]);
+		if (w[j] >= 2)
+			durw -= (w[j] - 2)*cw[j]*f.discount(w[j]);
+	}
+	ensure (fabs(f.present_value(w.size(), &w[0], &cw[0]) - pvw) < 100*eps*pvw);
+	ensure (fabs(f.duration(w.size(), &w[0], &cw[0], 2) - durw) < 100*eps*fabs(durw));
+
+	size_t mw[] = {100, 50};
+	U pvk[2];
+	f.present_value(2, mw, &w[0], &cw[0], pvk);
+	ensure (fabs(pvk[0] + pvk[1] - pvw) < 100*eps*pvw);
+	ensure (fabs(pvk[1] - f.present_value(50, &w[100], &cw[100])) < 100*eps*pvk[1]);
+}
+
+template<class T, class U>
+void forward_batch(void)
+{
+	T t[] = {1,2,3};
+	U f[] = {.1,.2,.3};
+	size_t n = dimof(t);
+
+	forward_batch_<T,U>(forward<T,U>(n, t, f, .4));
+	forward_batch_<T,U>(cached_forward<T,U>(n, t, f, .4));
+	forward_batch_<T,U>(forward<T,U>(0, 0, 0, .4));
+
+	// adjoint against bumped forwards with flows on, between, and past the knots
+	std::vector<T> u(100);
+	std::vector<U> c(u.size());
+	for (size_t j = 0; j < u.size(); ++j) {
+		u[j] = static_cast<T>(j)/25;
+		c[j] = 1 - static_cast<U>(j%3);
+	}
+	U df[dimof(f) + 1] = {0};
+	U pv = forward<T,U>(n, t, f, .4).present_value_adjoint(u.size(), &u[0], &c[0], df);
+	U h = static_cast<U>(1e-6);
+	for (size_t i = 0; i <= n; ++i) {
+		U fh[dimof(f) + 1] = {f[0], f[1], f[2], .4};
+		fh[i] += h;
+		U pvh = forward<T,U>(n, t, fh, fh[n]).present_value(u.size(), &u[0], &c[0]);
+		ensure (fabs((pvh - pv)/h - df[i]) < 1e-4*(1 + fabs(df[i])));
+	}
+}
+
 template<class T, class U>
 void bootstrap_test(void)
 {
@@ -134,12 +245,52 @@ void bootstrap_test(void)
 	ensure (fabs(f.back() - f0) < eps);
 }
 
+// first order greeks of a curve in one pass
+void forward_dual_test(void)
+{
+	typedef numerical::dual<double,3> D;
+	double eps = std::numeric_limits<double>::epsilon();
+
+	double t[] = {1, 2, 3};
+	D f[] = {D(.1, 0), D(.2, 1), D(.3, 2)};
+
+	// d/df[i] discount(u) = -discount(u) * time u spends in segment i
+	D d = forward<double,D>(3, t, f).discount(2.5);
+	ensure (fabs(d.value() - exp(-(.1 + .2 + .5*.3))) < eps);
+	ensure (fabs(d[0] + d.value()) < eps);
+	ensure (fabs(d[1] + d.value()) < eps);
+	ensure (fabs(d[2] + .5*d.value()) < eps);
+
+	D b[3];
+	forward<double,D>(3, t, f).discount(3, t, b);
+	ensure (b[0][1] == 0 && b[0][2] == 0);
+
+	// d(forward)/d(coupon) for a par swap with earlier forwards fixed
+	typedef numerical::dual<double,1> E;
+	E f0(0.04);
+	E e = exp(f0) - 1;
+	e[0] = 1;
+	double u[] = {0, 1, 2, 3};
+	E c[] = {-1, e, e, 1 + e};
+	E g[] = {f0, f0};
+	E f2 = forward<double,E>(2, t, g, .02).bootstrap(4, u, c);
+	ensure (fabs(f2.value() - .04) < 2*eps);
+	double a = 1 + e.value();
+	ensure (fabs(f2[0] - (a*a + a + 1)/a) < 1e-10);
+
+	E f1 = forward<double,E>().bootstrap1(1., 1 + e);
+	ensure (fabs(f1[0] - 1/(1 + e.value())) < 2*eps);
+}
+
 void curves_bootstrap_test(void)
 {
 	forward_constructors<double,double>();
 	forward_extrapolate<double,double>();
 	forward_value<double,double>();
 	forward_integral<double,double>();
+	cached_forward_integral<double,double>();
+	forward_batch<double,double>();
 	forward<double,double>();
 	bootstrap_test<double,double>();
+	forward_dual_test();
 }
\ No newline at end of file
@@ -3,7 +3,9 @@
 
 void curves_basis_spline_test(void);
 void curves_bootstrap_test(void);
+void curves_piecewise_polynomial_test(void);
 void curves_polynomial_test(void);
+void curves_pp_form_test(void);
 void curves_yield_curve_test(void);
 
 int
@@ -12,7 +14,9 @@ main()
 	try {
 		curves_basis_spline_test();
 		curves_bootstrap_test();
+		curves_piecewise_polynomial_test();
 		curves_polynomial_test();
+		curves_pp_form_test();
 		curves_yield_curve_test();
 	}
 	catch (const std::exception& ex) {
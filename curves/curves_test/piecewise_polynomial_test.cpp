@@ -0,0 +1,102 @@
+// piecewise_polynomial_test.cpp - test piecewise polynomials
+#include <cmath>
+#include <vector>
+#include "../../include/ensure.h"
+#include "../piecewise_polynomial.h"
+
+using namespace curves;
+
+template<class T>
+void piecewise_polynomial_test_(void)
+{
+	T t[] = {0, 0, 0, 0, 1, 2, 3, 3, 3, 3};
+	size_t n = sizeof(t)/sizeof(*t);
+
+	// clamped cubic with all coefficients 1 is 1
+	T a1[] = {1, 1, 1, 1, 1, 1};
+	piecewise_polynomial<T,T> one(a1, 3, n, t);
+	for (T x = 0; x < 3; x += T(0.1)) {
+		ensure (std::fabs(one(x) - 1) < 1e-12);
+		ensure (std::fabs(one.derivative(x)) < 1e-12);
+		ensure (std::fabs(one.integral(x) - x) < 1e-12);
+	}
+	ensure (one(-1) == 0);
+	ensure (one(3) == 0);
+
+	// compare derivative and integral with finite differences
+	T a[] = {1, -2, 0.5, 3, 2, -1};
+	piecewise_polynomial<T,T> p(a, 3, n, t);
+	T h = T(1e-5);
+	for (T x = T(0.05); x < 2.95; x += T(0.1)) {
+		T df = (p(x + h) - p(x - h))/(2*h);
+		ensure (std::fabs(p.derivative(x) - df) < 1e-6);
+
+		T dI = (p.integral(x + h) - p.integral(x - h))/(2*h);
+		ensure (std::fabs(p(x) - dI) < 1e-6);
+	}
+	ensure (p.integral(0) == 0);
+}
+
+// fixed order against runtime order
+template<class T, size_t K>
+void piecewise_polynomial_struct_test_(size_t N = 100000)
+{
+	std::vector<T> t, a;
+	for (size_t i = 0; i < 20; ++i)
+		t.push_back(static_cast<T>(i*i)/10);
+	for (size_t i = 0; i + K + 1 < t.size(); ++i)
+		a.push_back(static_cast<T>(1 + i%3));
+
+	piecewise_polynomial<T,T> p(&a[0], K, t.size(), &t[0]);
+	piecewise_polynomial_struct<T,T,K> q(&a[0], t.size(), &t[0]);
+
+	for (T x = -1; x < t.back() + 1; x += T(0.07)) {
+		ensure (std::fabs(p(x) - q(x)) < 1e-12);
+		ensure (std::fabs(p.derivative(x) - q.derivative(x)) < 1e-10);
+		ensure (std::fabs(p.integral(x) - q.integral(x)) < 1e-10);
+	}
+
+	T h = t.back()/N, s0(0), s(0);
+	for (size_t i = 0; i < N; ++i) {
+		s0 += p(i*h);
+		s += q(i*h);
+	}
+	ensure (std::fabs(s - s0) <= 1e-12*std::fabs(s0));
+}
+
+// batch functions on a sorted grid
+template<class T>
+void piecewise_polynomial_batch_test_(size_t N = 100000)
+{
+	T t[] = {0, 0, 0, 0, 0.5, 1, 1, 2, 3, 5, 5, 5, 5};
+	size_t n = sizeof(t)/sizeof(*t);
+	// n - k - 1 coefficients for order k, so size for k = 0
+	T a[] = {1, -2, 0.5, 3, 2, -1, 4, 1, 0, 2, -3, 1};
+
+	for (size_t k = 0; k <= 3; ++k) {
+		piecewise_polynomial<T,T> p(a, k, n, t);
+
+		std::vector<T> x(N), y(N), dy(N), Iy(N);
+		for (size_t i = 0; i < N; ++i)
+			x[i] = -1 + 7*static_cast<T>(i)/N;
+
+		p.evaluate(N, &x[0], &y[0]);
+		p.derivative(N, &x[0], &dy[0]);
+		p.integral(N, &x[0], &Iy[0]);
+		for (size_t i = 0; i < N; ++i) {
+			ensure (std::fabs(y[i] - p(x[i])) < 1e-12);
+			ensure (std::fabs(dy[i] - p.derivative(x[i])) < 1e-10);
+			ensure (std::fabs(Iy[i] - p.integral(x[i])) < 1e-10);
+		}
+	}
+}
+
+void curves_piecewise_polynomial_test(void)
+{
+	piecewise_polynomial_test_<double>();
+	piecewise_polynomial_batch_test_<double>();
+	piecewise_polynomial_struct_test_<double,0>();
+	piecewise_polynomial_struct_test_<double,1>();
+	piecewise_polynomial_struct_test_<double,2>();
+	piecewise_polynomial_struct_test_<double,3>();
+}
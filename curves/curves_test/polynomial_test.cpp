@@ -1,4 +1,9 @@
 // polynomial_test.cpp
+#include <cmath>
+#include <functional>
+#include <vector>
+#include "../../numerical/dual.h"
+#include "../../numerical/srng.h"
 #include "../../numerical/ulp.h"
 #include "../polynomial.h"
 
@@ -26,10 +31,130 @@ void curves_polynomial_(void)
 	ensure (abs(ulp(G(2), gx)) <= 1);
 }
 
+// derivatives with respect to x and to the leading coefficient
+void curves_polynomial_dual(void)
+{
+	typedef dual<double,2> D;
+
+	D x(2, 0);
+	D p[3] = {1, 2, D(3, 1)};
+	D y = horner<D,D>(3, p)(x);
+	ensure (y.value() == 1 + 2*2 + 3*2*2);
+	ensure (y[0] == 2 + 2*3*2);
+	ensure (y[1] == 2*2);
+
+	double q[4] = {1, 2, 3, 4};
+	D z = taylor<D,double>(4, q)(x);
+	ensure (fabs(z.value() - (1 + 2*2 + 3*2*2/2. + 4*2*2*2/6.)) < 1e-14);
+	ensure (fabs(z[0] - (2 + 3*2 + 4*2*2/2.)) < 1e-14);
+	ensure (z[1] == 0);
+}
+
+// previous recursive version for comparison
+template<class T, class U>
+inline std::function<T(T)> horner_recursive(size_t n, const U* p)
+{
+	return [n,p](const T& x) -> T {
+		return static_cast<T>(n == 0 ? 0 : (n == 1 || x == 0)
+				? p[0] : p[0] + x*horner_recursive<T,U>(n - 1, p + 1)(x));
+	};
+}
+
+template<class T>
+void curves_polynomial_estrin(void)
+{
+	numerical::srng rng(1, 2);
+
+	for (size_t n = 0; n <= 25; ++n) {
+		std::vector<T> p(n + 1);
+		for (size_t i = 0; i < n; ++i)
+			p[i] = static_cast<T>(rng.uniform(-1, 1));
+
+		auto F = horner<T,T>(n, &p[0]);
+		auto G = estrin<T,T>(n, &p[0]);
+		for (T x = -1; x <= 1; x += T(0.125)) {
+			T y = F(x);
+			ensure (std::fabs(G(x) - y) <= 32*std::numeric_limits<T>::epsilon());
+		}
+	}
+}
+
+void curves_polynomial_batch(size_t N = 10000)
+{
+	numerical::srng rng(1, 2);
+	size_t n = 21;
+	std::vector<double> p(n), x(N), y(N), z(N);
+
+	for (size_t i = 0; i < n; ++i)
+		p[i] = rng.uniform(-1, 1);
+	for (size_t i = 0; i < N; ++i)
+		x[i] = rng.uniform(-1, 1);
+	x[0] = 0;
+
+	// recursive std::function
+	auto F0 = horner_recursive<double,double>(n, &p[0]);
+	for (size_t i = 0; i < N; ++i)
+		z[i] = F0(x[i]);
+
+	auto F = horner<double,double>(n, &p[0]);
+	for (size_t i = 0; i < N; ++i)
+		ensure (F(x[i]) == z[i]);
+
+	// same value up to rounding
+	auto G = estrin<double,double>(n, &p[0]);
+	for (size_t i = 0; i < N; ++i)
+		ensure (std::fabs(G(x[i]) - z[i]) < 1e-13);
+
+	horner(n, &p[0], N, &x[0], &y[0]);
+	for (size_t i = 0; i < N; ++i)
+		ensure (y[i] == z[i]);
+
+	// in place
+	horner(n, &p[0], N, &x[0], &x[0]);
+	for (size_t i = 0; i < N; ++i)
+		ensure (x[i] == z[i]);
+}
+
+// (x - 1)^n expanded is ill conditioned near 1
+template<class T>
+void curves_polynomial_compensated(void)
+{
+	for (size_t n = 3; n <= 7; ++n) {
+		std::vector<T> p(n + 1);
+		T b(1);
+		for (size_t i = 0; i <= n; ++i) {
+			p[n - i] = (i%2 ? -b : b);
+			b = b*(n - i)/(i + 1);
+		}
+
+		auto F = horner<T,T>(n + 1, &p[0]);
+		auto G = compensated_horner<T,T>(n + 1, &p[0]);
+		typename ulp_traits<T>::integer maxF(0), maxG(0);
+		for (size_t j = 1; j < 8; ++j) {
+			T x = 1 + (j + T(1)/3)/32;
+			T y = std::pow(x - 1, static_cast<int>(n)); // x - 1 is exact
+			maxF = std::max(maxF, std::abs(ulp(F(x), y)));
+			maxG = std::max(maxG, std::abs(ulp(G(x), y)));
+		}
+		ensure (maxG <= 3);
+		ensure (maxF > 1000);
+	}
+
+	// agrees with horner when well conditioned
+	T q[] = {1, 2, 3, 4};
+	auto G = compensated_horner<T,T>(4, q);
+	ensure (G(0) == 1);
+	ensure (G(2) == 1 + 2*2 + 3*4 + 4*8);
+}
+
 void curves_polynomial_test(void)
 {
 	curves_polynomial_<float,float>();
 	curves_polynomial_<double,double>();
+	curves_polynomial_dual();
+	curves_polynomial_estrin<double>();
+	curves_polynomial_batch();
+	curves_polynomial_compensated<double>();
 }
 
 
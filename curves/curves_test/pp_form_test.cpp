@@ -0,0 +1,56 @@
+// pp_form_test.cpp - test power basis form of piecewise polynomials
+#include <cmath>
+#include "../../include/ensure.h"
+#include "../piecewise_polynomial.h"
+#include "../pp_form.h"
+
+using namespace curves;
+
+template<class T>
+void pp_form_test_(void)
+{
+	T t[] = {0, 0, 0, 0, 0.5, 1, 1, 2, 3, 5, 5, 5, 5};
+	size_t n = sizeof(t)/sizeof(*t);
+	// n - k - 1 coefficients for order k, so size for k = 0
+	T a[] = {1, -2, 0.5, 3, 2, -1, 4, 1, 0, 2, -3, 1};
+
+	for (size_t k = 0; k <= 3; ++k) {
+		piecewise_polynomial<T,T> p(a, k, n, t);
+		pp_form<T,T> q(a, k, n, t);
+
+		ensure (q.order() == k);
+		ensure (q.size() == 5);
+		ensure (q.breakpoints()[q.size()] == 5);
+
+		for (T x = -1; x < 6; x += T(0.01)) {
+			ensure (std::fabs(p(x) - q(x)) < 1e-12);
+			ensure (std::fabs(p.derivative(x) - q.derivative(x)) < 1e-10);
+			ensure (std::fabs(p.integral(x) - q.integral(x)) < 1e-10);
+		}
+	}
+}
+
+// sums over a fine grid
+template<class T>
+void pp_form_grid_test_(size_t N = 100000)
+{
+	T t[] = {0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 8, 8};
+	size_t n = sizeof(t)/sizeof(*t);
+	T a[] = {1, 2, 0, 3, 1, -1, 2, 4, 1, 0, 1};
+
+	piecewise_polynomial<T,T> p(a, 3, n, t);
+	pp_form<T,T> q(a, 3, n, t);
+	T h = t[n - 1]/N, s0(0), s(0);
+
+	for (size_t i = 0; i < N; ++i) {
+		s0 += p(i*h);
+		s += q(i*h);
+	}
+	ensure (std::fabs(s - s0) < 1e-10*std::fabs(s0));
+}
+
+void curves_pp_form_test(void)
+{
+	pp_form_test_<double>();
+	pp_form_grid_test_<double>();
+}
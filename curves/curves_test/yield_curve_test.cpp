@@ -1,4 +1,5 @@
 // yield_curve_test.cpp
+#include <vector>
 #include "../yield_curve.h"
 
 using namespace curves::pwflat;
@@ -7,7 +8,6 @@ template<class T, class F>
 void yield_curve_test(void)
 {
 	T eps = std::numeric_limits<T>::epsilon();
-	T t[] = {1, 2, 3, 4};
 	// present_value of (0, -1), (1, e), ..., (n, 1+e) is 0 for f(t) = f0.
 	F f0 = (F)0.04;
 	F e = exp(f0) - 1;
@@ -26,9 +26,139 @@ void yield_curve_test(void)
 	const forward<T,F>& f = yc.forward();
 	for (size_t i = 0; i < yc.forward().size(); ++i)
 		ensure (fabs(f[i] - f0) < eps);
+
+	T v[] = {.5, 1, 1.5, 2, 2.5, 3, 3.5, 4};
+	F D[sizeof(v)/sizeof(*v)];
+	yc.discount(8, v, D);
+	for (size_t i = 0; i < 8; ++i)
+		ensure (fabs(D[i] - exp(-f0*v[i])) < 2*eps);
+
+	size_t m[] = {4, 5};
+	T w[] = {0, 1, 2, 3,  0, 1, 2, 3, 4};
+	F c[] = {-1, e, e, 1 + e,  -1, e, e, e, 1 + e};
+	F pv[2];
+	yc.present_value(2, m, w, c, pv);
+	ensure (fabs(pv[0]) < 2*eps);
+	ensure (fabs(pv[1]) < 2*eps);
+}
+
+template<class T, class F>
+void yield_curve_update_test(void)
+{
+	T eps = std::numeric_limits<T>::epsilon();
+	F f0 = (F)0.04, f1 = (F)0.05;
+	F e = exp(f0) - 1;
+	F e1 = exp(f1) - 1;
+	T u[]  = {0, 1, 2, 3, 4, 5};
+	F c3[] = {-1, e, e, 1 + e};
+	F c4[] = {-1, e, e, e, 1 + e};
+	F c5[] = {-1, e, e, e, e, 1 + e};
+	F d3[] = {-1, e1, e1, 1 + e1};
+
+	yield_curve<T,F> yc;
+	yc.add(1., 1 + e)
+	  .add(1., -1., 2., 1 + e)
+	  .add(4, u, c3)
+	  .add(5, u, c4)
+	  .add(6, u, c5);
+	ensure (yc.instruments() == 5);
+
+	// reprice the 3 year swap at a higher rate
+	auto r = yc.update(2, 4, u, d3);
+	ensure (r.first == 2);
+	ensure (r.forward.size() == 3);
+	ensure (r.elapsed >= 0);
+
+	yield_curve<T,F> yc1;
+	yc1.add(1., 1 + e)
+	  .add(1., -1., 2., 1 + e)
+	  .add(4, u, d3)
+	  .add(5, u, c4)
+	  .add(6, u, c5);
+
+	forward<T,F> f = yc.forward(), f1_ = yc1.forward();
+	ensure (f[0] == f1_[0] && f[1] == f1_[1]);
+	for (size_t i = 2; i < f.size(); ++i) {
+		ensure (fabs(r.forward[i - 2] - f[i]) == 0);
+		ensure (fabs(f[i] - f1_[i]) < 10*eps);
+	}
+	ensure (fabs(f.present_value(4, u, d3)) < 10*eps);
+	ensure (fabs(f.present_value(6, u, c5)) < 10*eps);
+
+	// price change back to par on original flows
+	yc.update(2, 4, u, c3);
+	r = yc.update(2, 0);
+	f = yc.forward();
+	for (size_t i = 0; i < f.size(); ++i)
+		ensure (fabs(f[i] - f0) < 10*eps);
+
+	// nonzero price
+	r = yc.update(3, F(0.01));
+	f = yc.forward();
+	ensure (fabs(f.present_value(5, u, c4) - F(0.01)) < 10*eps);
+	ensure (fabs(f.present_value(6, u, c5)) < 10*eps);
+
+	// cash deposit prices are present values like any other instrument
+	T t1 = 1;
+	F c1 = 1 + e;
+	yield_curve<T,F> y1;
+	y1.add(1, &t1, &c1, F(0.98));
+	ensure (y1.price(0) == F(0.98));
+	ensure (fabs(y1.forward().present_value(1, &t1, &c1) - F(0.98)) < 10*eps);
+	r = y1.update(0, 1);
+	ensure (fabs(r.forward[0] - f0) < 10*eps);
+	ensure (yc.price(0) == 1);
+}
+
+template<class T, class F>
+void yield_curve_sensitivity_test(void)
+{
+	F e = exp((F)0.04) - 1;
+	T u[]  = {0, 1, 2, 3, 4, 5};
+	F c3[] = {-1, e, e, 1 + e};
+	F c4[] = {-1, e, e, e, 1 + e};
+	F c5[] = {-1, e, e, e, e, 1 + e};
+
+	yield_curve<T,F> yc;
+	yc.add(1., 1 + e)
+	  .add(1., -1., 2., 1 + e)
+	  .add(4, u, c3)
+	  .add(5, u, c4)
+	  .add(6, u, c5);
+
+	// portfolio between knots
+	T v[] = {.5, 1.5, 2.5, 3.25, 4.75};
+	F c[] = {1, 2, -1, 3, 100};
+	size_t m = sizeof(v)/sizeof(*v);
+
+	std::vector<F> dp = yc.sensitivity(m, v, c);
+	ensure (dp.size() == yc.instruments());
+
+	// bump and reprice
+	F h = (F)1e-6;
+	F pv0 = yc.forward().present_value(m, v, c);
+	for (size_t k = 0; k < yc.instruments(); ++k) {
+		yield_curve<T,F> yk(yc);
+		yk.update(k, yc.price(k) + h);
+		F dpk = (yk.forward().present_value(m, v, c) - pv0)/h;
+		ensure (fabs(dpk - dp[k]) < 1e-4*(1 + fabs(dp[k])));
+	}
+
+	// bumping the cash deposit rate
+	yield_curve<T,F> y0;
+	y0.add(1., 1 + e + h)
+	  .add(1., -1., 2., 1 + e)
+	  .add(4, u, c3)
+	  .add(5, u, c4)
+	  .add(6, u, c5);
+	F dr = (y0.forward().present_value(m, v, c) - pv0)/h;
+	// d(pv)/dr = -lambda[0] dc/dr D(u)
+	ensure (fabs(dr + dp[0]*yc.forward().discount(1)) < 1e-4*(1 + fabs(dr)));
 }
 
 void curves_yield_curve_test(void)
 {
 	yield_curve_test<double,double>();
+	yield_curve_update_test<double,double>();
+	yield_curve_sensitivity_test<double,double>();
 }
\ No newline at end of file
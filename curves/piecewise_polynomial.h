@@ -1,30 +1,59 @@
 // piecewise_polynomial.h - Piecewise polynomial functions.
 // Copyright (c) 2013 KALX, LLC. All rights reserved.
 #pragma once
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 #include "basis_spline.h"
 
 namespace curves {
 
+	// sum_i a[i] B(i,k)(x) for i < n - k - 1
 	template<class T, class U>
 	class piecewise_polynomial {
 		const T* a_; // size n - k - 1
 		size_t k_, n_;
 		const U* t_;
+
+		// points per block in the batch functions
+		static const size_t block = 16;
+
+		// Call f(mu, m, B, y) for blocks of m points in [t[mu], t[mu+1]) where
+		// B[r*block + p] = B(mu - k + r, k)(x[p]). Points outside of [t[0], t[n-1]) are 0.
+		// The knots are walked once so x must be sorted.
+		template<class F>
+		void sweep_(size_t k, size_t m, const T* x, T* y, F f) const
+		{
+			T B[(curves::basis_spline::max_order + 1)*block];
+			size_t mu = 0;
+
+			for (size_t i = 0; i < m; ) {
+				if (x[i] < t_[0] || !(x[i] < t_[n_ - 1])) {
+					y[i++] = 0;
+
+					continue;
+				}
+
+				ensure (!(x[i] < t_[mu]));
+				while (!(x[i] < t_[mu + 1]))
+					++mu;
+
+				size_t j = i + 1;
+				while (j < m && j - i < block && !(x[j] < t_[mu]) && x[j] < t_[mu + 1])
+					++j;
+
+				curves::basis_spline::values(k, n_, t_, mu, j - i, x + i, B, block);
+				f(mu, j - i, B, y + i);
+
+				i = j;
+			}
+		}
 	public:
 		piecewise_polynomial(const T* a, size_t k, size_t n, const U* t)
 			: a_(a), k_(k), n_(n), t_(t)
-		{ }
-		piecewise_polynomial(const piecewise_polynomial& P)
-			: a_(P.a_), B_(P.B_)
-		{ }
-		piecewise_polynomial& operator=(const piecewise_polynomial& P)
 		{
-			if (this != &P) {
-				a_ = P.a_;
-				B_ = P.B_;
-			}
-
-			return *this;
+			ensure (k_ + 1 <= curves::basis_spline::max_order);
+			ensure (n_ > k_ + 1);
 		}
 		~piecewise_polynomial()
 		{ }
@@ -34,59 +63,288 @@ namespace curves {
 			T p(0);
 
 			// localize based on x
-			const U* lb = std::lower_bound(t_, t_ + n_, x);
-			if (lb == t_ + n_)
-				return 0;
+			size_t mu = curves::basis_spline::interval(n_, t_, x);
+			if (mu == n_)
+				return p;
 
-			auto B = curves::basis_spline::value<T,U>(k_, n_, t_);
-			size_t i0 = lb - t_;
-			for (size_t i = i0; i < i0 + k_ + 1 && i < n_ - k_ - 1; ++i)
-				p += a_[i]*B(i, x);
+			// B[r] = B(mu - k + r, k)(x)
+			T B[curves::basis_spline::max_order + 1];
+			curves::basis_spline::values(k_, n_, t_, mu, x, B);
+			for (size_t r = 0; r <= k_; ++r) {
+				size_t i = mu + r - k_;
+				if (mu + r >= k_ && i + k_ + 1 < n_)
+					p += a_[i]*B[r];
+			}
 
 			return p;
 		}
+		// sum_i a[i] k (B(i,k-1)/(t[i+k] - t[i]) - B(i+1,k-1)/(t[i+k+1] - t[i+1]))
 		T derivative(T x) const
 		{
 			T p(0);
 
-			// localize based on x
-			const U* lb = std::lower_bound(t_, t_ + n_, x);
-			if (lb == t_ + n_)
-				return 0;
+			size_t mu = curves::basis_spline::interval(n_, t_, x);
+			if (mu == n_ || k_ == 0)
+				return p;
+
+			// B[r] = B(mu - k + 1 + r, k - 1)(x)
+			T B[curves::basis_spline::max_order + 1];
+			curves::basis_spline::values(k_ - 1, n_, t_, mu, x, B);
+			// coefficient of B(j,k-1) is k (a[j] - a[j-1])/(t[j+k] - t[j])
+			for (size_t r = 0; r < k_; ++r) {
+				size_t j = mu + 1 + r - k_;
+				if (mu + 1 + r < k_ || j + k_ >= n_)
+					continue;
 
-			auto B = curves::basis_spline::derivative<T,U>(k_, n_, t_);
-			size_t i0 = lb - t_;
-			for (size_t i = i0; i < i0 + k_ + 1 && i < n_ - k_ - 1; ++i)
-				p += a_[i]*B(i, x);
+				T dt = static_cast<T>(t_[j + k_] - t_[j]);
+				if (!dt)
+					continue;
+
+				T da(0);
+				if (j + k_ + 1 < n_)
+					da += a_[j];
+				if (j > 0)
+					da -= a_[j - 1];
+
+				p += k_*da*B[r]/dt;
+			}
 
 			return p;
 		}
+		// sum_i a[i] (t[i+k+1] - t[i])/(k+1) sum_{j>=i} B(j,k+1)(x)
 		T integral(T x) const
 		{
 			T p(0);
 
-			// localize based on x
-			const U* lb = std::lower_bound(t_, t_ + n_, x);
-			if (lb == t_ + n_)
-				return 0;
+			size_t mu = curves::basis_spline::interval(n_, t_, x);
+			if (mu == n_)
+				return p;
+
+			// B[r] = B(mu - k - 1 + r, k + 1)(x)
+			T B[curves::basis_spline::max_order + 1];
+			curves::basis_spline::values(k_ + 1, n_, t_, mu, x, B);
 
-			auto B = curves::basis_spline::integral<T,U>(k_, n_, t_);
-			size_t i0 = lb - t_;
-			for (size_t i = i0; i < i0 + k_ + 1 && i < n_ - k_ - 1; ++i)
-				p += a_[i]*B(i, x);
+			// S = sum_{j >= i} B(j,k+1)(x) = S0 - sum_{j < i} B(j,k+1)(x)
+			// where S0 = 1 if the splines past the last knot would be needed
+			T S = curves::basis_spline::sum(k_ + 1, n_, mu, B);
+			for (size_t i = 0; i <= mu && i + k_ + 2 <= n_; ++i) {
+				p += a_[i]*S*(t_[i + k_ + 1] - t_[i])/(k_ + 1);
+				if (i + k_ + 1 >= mu)
+					S -= B[i + k_ + 1 - mu];
+			}
 
 			return p;
 		}
+
+		// y[i] = p(x[i]) for sorted x
+		void evaluate(size_t m, const T* x, T* y) const
+		{
+			const T* a = a_;
+			size_t k = k_, n = n_;
+
+			sweep_(k_, m, x, y, [a,k,n](size_t mu, size_t m, const T* B, T* y) {
+				for (size_t p = 0; p < m; ++p)
+					y[p] = 0;
+
+				for (size_t r = 0; r <= k; ++r) {
+					size_t i = mu + r - k;
+					if (mu + r < k || i + k + 1 >= n)
+						continue;
+
+					const T* Br = B + r*block;
+					for (size_t p = 0; p < m; ++p)
+						y[p] += a[i]*Br[p];
+				}
+			});
+		}
+		// y[i] = p'(x[i]) for sorted x
+		void derivative(size_t m, const T* x, T* y) const
+		{
+			if (k_ == 0) {
+				for (size_t i = 0; i < m; ++i)
+					y[i] = 0;
+
+				return;
+			}
+
+			const T* a = a_;
+			size_t k = k_, n = n_;
+			const U* t = t_;
+
+			sweep_(k_ - 1, m, x, y, [a,k,n,t](size_t mu, size_t m, const T* B, T* y) {
+				for (size_t p = 0; p < m; ++p)
+					y[p] = 0;
+
+				// coefficient of B(j,k-1) is k (a[j] - a[j-1])/(t[j+k] - t[j])
+				for (size_t r = 0; r < k; ++r) {
+					size_t j = mu + 1 + r - k;
+					if (mu + 1 + r < k || j + k >= n)
+						continue;
+
+					T dt = static_cast<T>(t[j + k] - t[j]);
+					if (!dt)
+						continue;
+
+					T da(0);
+					if (j + k + 1 < n)
+						da += a[j];
+					if (j > 0)
+						da -= a[j - 1];
+					da = k*da/dt;
+
+					const T* Br = B + r*block;
+					for (size_t p = 0; p < m; ++p)
+						y[p] += da*Br[p];
+				}
+			});
+		}
+		// y[i] = int_{t[0]}^{x[i]} p(u) du for sorted x
+		void integral(size_t m, const T* x, T* y) const
+		{
+			// b[j] = sum_{i <= j} a[i] (t[i+k+1] - t[i])/(k+1)
+			std::vector<T> b(n_ - k_ - 1);
+			T bj(0);
+			for (size_t i = 0; i < b.size(); ++i) {
+				bj += a_[i]*(t_[i + k_ + 1] - t_[i])/(k_ + 1);
+				b[i] = bj;
+			}
+
+			const T* pb = &b[0];
+			size_t k = k_ + 1, n = n_, nb = b.size();
+
+			// sum_{i <= I} a[i] (t[i+k+1] - t[i])/(k+1) (S - sum_{j < i} B(j,k+1))
+			// = S b[I] - sum_{j < I} B(j,k+1) (b[I] - b[j]), I = min(mu, nb - 1)
+			sweep_(k, m, x, y, [pb,k,n,nb](size_t mu, size_t m, const T* B, T* y) {
+				size_t I = std::min(mu, nb - 1);
+				// S = 1 as in basis_spline::sum
+				bool unity = mu + k + 1 >= n && mu >= k;
+
+				for (size_t p = 0; p < m; ++p)
+					y[p] = unity ? pb[I] : 0;
+
+				for (size_t r = 0; r <= k; ++r) {
+					if (mu + r < k)
+						continue;
+
+					size_t j = mu + r - k;
+					T c = j < I ? pb[j] - pb[I] : 0;
+					if (!unity)
+						c += pb[I];
+
+					const T* Br = B + r*block;
+					for (size_t p = 0; p < m; ++p)
+						y[p] += c*Br[p];
+				}
+			});
+		}
 	};
-/*
+
+	// sum_i a[i] B(i,K)(x) for fixed order K
 	template<class T, class U, size_t K>
-	inline std::function<T(T)> piecewise_polynomial(const T* a, size_t n, const U* t)
-	{
-		return [a,n,t](T x) -> T {
-			return piecewise_polynomial_struct<T,U,K>(a, basis_spline_struct<U,K>(n, t))(x);
-		};
-	}
-*/
+	class piecewise_polynomial_struct {
+		const T* a_; // size n - K - 1
+		basis_spline_struct<U,K> B_;
+
+		T derivative_(T, std::true_type) const
+		{
+			return T(0);
+		}
+		T derivative_(T x, std::false_type) const
+		{
+			T p(0);
+			size_t n = B_.size();
+			const U* t = B_.knots();
+
+			size_t mu = B_.interval(x);
+			if (mu == n)
+				return p;
+
+			// B[r] = B(mu - K + 1 + r, K - 1)(x)
+			T B[K];
+			B_.template values<K - 1>(mu, x, B);
+			for (size_t r = 0; r < K; ++r) {
+				size_t j = mu + 1 + r - K;
+				if (mu + 1 + r < K || j + K >= n)
+					continue;
+
+				T dt = static_cast<T>(t[j + K] - t[j]);
+				if (!dt)
+					continue;
+
+				T da(0);
+				if (j + K + 1 < n)
+					da += a_[j];
+				if (j > 0)
+					da -= a_[j - 1];
+
+				p += K*da*B[r]/dt;
+			}
+
+			return p;
+		}
+	public:
+		piecewise_polynomial_struct(const T* a, const basis_spline_struct<U,K>& B)
+			: a_(a), B_(B)
+		{ }
+		piecewise_polynomial_struct(const T* a, size_t n, const U* t)
+			: a_(a), B_(n, t)
+		{ }
+
+		T operator()(T x) const
+		{
+			T p(0);
+			size_t n = B_.size();
+
+			size_t mu = B_.interval(x);
+			if (mu == n)
+				return p;
+
+			// B[r] = B(mu - K + r, K)(x)
+			T B[K + 1];
+			B_.values(mu, x, B);
+			if (mu >= K && mu + 1 < n - K) {
+				const T* a = a_ + (mu - K);
+				for (size_t r = 0; r <= K; ++r)
+					p += a[r]*B[r];
+			}
+			else {
+				for (size_t r = 0; r <= K; ++r) {
+					size_t i = mu + r - K;
+					if (mu + r >= K && i + K + 1 < n)
+						p += a_[i]*B[r];
+				}
+			}
+
+			return p;
+		}
+		T derivative(T x) const
+		{
+			return derivative_(x, std::integral_constant<bool, K == 0>());
+		}
+		T integral(T x) const
+		{
+			T p(0);
+			size_t n = B_.size();
+			const U* t = B_.knots();
+
+			size_t mu = B_.interval(x);
+			if (mu == n)
+				return p;
+
+			// B[r] = B(mu - K - 1 + r, K + 1)(x)
+			T B[K + 2];
+			B_.template values<K + 1>(mu, x, B);
+
+			T S = curves::basis_spline::sum(K + 1, n, mu, B);
+			for (size_t i = 0; i <= mu && i + K + 2 <= n; ++i) {
+				p += a_[i]*S*(t[i + K + 1] - t[i])/(K + 1);
+				if (i + K + 1 >= mu)
+					S -= B[i + K + 1 - mu];
+			}
+
+			return p;
+		}
+	};
 
 } // namespace curves
 
@@ -3,8 +3,8 @@
 // Parameterize by argument T - float, double, dual number, matrix
 // and coefficients U are typically scalar
 #pragma once
+#include <algorithm>
 #include <cmath>
-#include <functional>
 #include "../include/ensure.h"
 #include "../numerical/ulp.h"
 
@@ -13,23 +13,188 @@ namespace polynomial {
 
 	// p[0] + p[1]*x + ...  = p[0] + x*(p[1] + ...)
 	template<class T, class U>
-	inline std::function<T(T)> horner(size_t n, const U* p)
+	struct horner_struct {
+		size_t n;
+		const U* p;
+
+		horner_struct(size_t n, const U* p)
+			: n(n), p(p)
+		{ }
+		T operator()(const T& x) const
+		{
+			if (n == 0)
+				return T(0);
+			if (n == 1 || x == 0)
+				return static_cast<T>(p[0]);
+
+			T y = static_cast<T>(p[n - 1]);
+			for (size_t i = n - 1; i-- > 0; )
+				y = static_cast<T>(p[i] + x*y);
+
+			return y;
+		}
+	};
+	template<class T, class U>
+	inline horner_struct<T,U> horner(size_t n, const U* p)
 	{
-		return [n,p](const T& x) -> T {
-			return static_cast<T>(n == 0 ? 0 : (n == 1 || x == 0)
-					? p[0] : p[0] + x*horner<T,U>(n - 1, p + 1)(x));
-		};
+		return horner_struct<T,U>(n, p);
 	}
-		
+
+	// y[i] = p[0] + x[i]*(p[1] + ...) for i < m, point loop innermost
+	// x and y may be the same array
+	template<class T, class U>
+	inline void horner(size_t n, const U* p, size_t m, const T* x, T* y)
+	{
+		static const size_t block = 64;
+		T x_[block];
+
+		for (size_t i = 0; i < m; i += block) {
+			size_t b = std::min(block, m - i);
+			T* yi = y + i;
+
+			std::copy(x + i, x + i + b, x_);
+			for (size_t l = 0; l < b; ++l)
+				yi[l] = static_cast<T>(n ? p[n - 1] : 0);
+			for (size_t j = n; j-- > 1; )
+				for (size_t l = 0; l < b; ++l)
+					yi[l] = static_cast<T>(p[j - 1] + x_[l]*yi[l]);
+		}
+	}
+
+	// Estrin's scheme in blocks of 8 coefficients combined by Horner in x^8
+	// p[0] + p[1] x + (p[2] + p[3] x) x^2 + ((p[4] + p[5] x) + (p[6] + p[7] x) x^2) x^4 + ...
+	template<class T, class U>
+	struct estrin_struct {
+		size_t n;
+		const U* p;
+
+		estrin_struct(size_t n, const U* p)
+			: n(n), p(p)
+		{ }
+		T operator()(const T& x) const
+		{
+			if (n == 0)
+				return T(0);
+			if (n == 1 || x == 0)
+				return static_cast<T>(p[0]);
+
+			T x2 = x*x;
+			T x4 = x2*x2;
+			T x8 = x4*x4;
+
+			size_t i = (n - 1) & ~size_t(7); // last block
+			T y = block(i, x, x2, x4);
+			while (i) {
+				i -= 8;
+				y = block(i, x, x2, x4) + x8*y;
+			}
+
+			return y;
+		}
+	private:
+		// p[i] + ... + p[i+7] x^7 with missing coefficients 0
+		T block(size_t i, const T& x, const T& x2, const T& x4) const
+		{
+			T q[8];
+
+			for (size_t j = 0; j < 8; ++j)
+				q[j] = static_cast<T>(i + j < n ? p[i + j] : 0);
+
+			T q01 = q[0] + q[1]*x;
+			T q23 = q[2] + q[3]*x;
+			T q45 = q[4] + q[5]*x;
+			T q67 = q[6] + q[7]*x;
+
+			return (q01 + q23*x2) + (q45 + q67*x2)*x4;
+		}
+	};
+	template<class T, class U>
+	inline estrin_struct<T,U> estrin(size_t n, const U* p)
+	{
+		return estrin_struct<T,U>(n, p);
+	}
+
+	// error free transformations: a + b = s + e and a*b = p + e exactly
+	template<class T>
+	inline void two_sum(T a, T b, T& s, T& e)
+	{
+		s = a + b;
+		T z = s - a;
+		e = (a - (s - z)) + (b - z);
+	}
+	template<class T>
+	inline void two_product(T a, T b, T& p, T& e)
+	{
+		p = a*b;
+		e = std::fma(a, b, -p);
+	}
+
+	// Horner with the rounding errors of each step accumulated in a second
+	// Horner sum. The result is as accurate as Horner in twice the precision.
+	// T must be a floating point type.
+	template<class T, class U>
+	struct compensated_horner_struct {
+		size_t n;
+		const U* p;
+
+		compensated_horner_struct(size_t n, const U* p)
+			: n(n), p(p)
+		{ }
+		T operator()(const T& x) const
+		{
+			if (n == 0)
+				return T(0);
+
+			T y = static_cast<T>(p[n - 1]), c(0);
+			for (size_t i = n - 1; i-- > 0; ) {
+				T yx, ep, es;
+
+				two_product(y, x, yx, ep);
+				two_sum(yx, static_cast<T>(p[i]), y, es);
+				c = c*x + (ep + es);
+			}
+
+			return y + c;
+		}
+	};
+	template<class T, class U>
+	inline compensated_horner_struct<T,U> compensated_horner(size_t n, const U* p)
+	{
+		return compensated_horner_struct<T,U>(n, p);
+	}
+
 	// p[0] + p[1] x + p[2]/2! x + ...  + p[n-1]/(n-1)! x^(n-1)
 	// = p[0] + x (p[1] + x/2 (p[2] + x/3 (p[3] + ... + x/(n-1) p[n-1])))
 	template<class T, class U>
-	inline std::function<T(T)> taylor(size_t n, const U* p, T f = 1)
+	struct taylor_struct {
+		size_t n;
+		const U* p;
+		T f;
+
+		taylor_struct(size_t n, const U* p, T f = 1)
+			: n(n), p(p), f(f)
+		{ }
+		T operator()(const T& x) const
+		{
+			if (n == 0)
+				return T(0);
+			if (n == 1)
+				return static_cast<T>(p[0]);
+
+			T y = static_cast<T>(p[n - 1]);
+			T fi = f + static_cast<T>(n - 2);
+			for (size_t i = n - 1; i-- > 0; ) {
+				y = static_cast<T>(p[i] + (x/fi)*y);
+				fi = fi - 1;
+			}
+
+			return y;
+		}
+	};
+	template<class T, class U>
+	inline taylor_struct<T,U> taylor(size_t n, const U* p, T f = 1)
 	{
-		return [n,p,f](const T& x) -> T {
-			return static_cast<T>(n == 0 ? 0 : n == 1 ? p[0]
-				: p[0] + (x/f)*taylor<T,U>(n - 1, p + 1, f + 1)(x));
-		};
+		return taylor_struct<T,U>(n, p, f);
 	}
 
 } // namespace polynomial
@@ -0,0 +1,161 @@
+// pp_form.h - piecewise polynomials in local power basis form
+// Copyright (c) 2013 KALX, LLC. All rights reserved.
+// Converts sum_i a[i] B(i,k)(x) once to p(x) = sum_j c[j][l] (x - x[l])^j
+// for x[l] <= x < x[l+1]. Coefficients are stored by power, c[j*m + l],
+// so evaluation is one breakpoint search and a Horner loop.
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "basis_spline.h"
+
+namespace curves {
+
+	template<class T, class U>
+	class pp_form {
+		size_t k_, m_;         // order and number of intervals
+		std::vector<U> x_;     // breakpoints, size m + 1
+		std::vector<T> c_;     // c_[j*m + l] coefficient of (x - x[l])^j, j <= k
+		std::vector<T> dc_;    // derivative coefficients, j < k
+		std::vector<T> ic_;    // antiderivative coefficients, j <= k + 1, ic_[l] = integral to x[l]
+
+		// index of interval containing x or m if x is not in [x[0], x[m])
+		size_t interval(T x) const
+		{
+			if (m_ == 0 || x < x_[0] || !(x < x_[m_]))
+				return m_;
+
+			return std::upper_bound(x_.begin(), x_.end(), x) - x_.begin() - 1;
+		}
+		// sum_{j < n} c[j*m + l] h^j
+		T horner(size_t n, const T* c, size_t l, T h) const
+		{
+			if (n == 0)
+				return T(0);
+
+			T p = c[(n - 1)*m_ + l];
+			for (size_t j = n - 1; j-- > 0; )
+				p = p*h + c[j*m_ + l];
+
+			return p;
+		}
+	public:
+		// knots t of size n and coefficients a of size n - k - 1
+		pp_form(const T* a, size_t k, size_t n, const U* t)
+			: k_(k), m_(0)
+		{
+			ensure (k_ + 1 <= curves::basis_spline::max_order);
+			ensure (n > k_ + 1);
+
+			// d[r] are the coefficients of the r-th derivative, a spline of order k - r
+			std::vector<std::vector<T>> d(k_ + 1);
+			d[0].assign(a, a + n - k_ - 1);
+			for (size_t r = 1; r <= k_; ++r) {
+				size_t kr = k_ - r + 1;
+				const std::vector<T>& a_ = d[r - 1];
+
+				d[r].resize(n - kr);
+				for (size_t j = 0; j < d[r].size(); ++j) {
+					T dt = static_cast<T>(t[j + kr] - t[j]);
+					T da(0);
+					if (j < a_.size())
+						da += a_[j];
+					if (j > 0)
+						da -= a_[j - 1];
+
+					d[r][j] = dt ? kr*da/dt : T(0);
+				}
+			}
+
+			std::vector<size_t> mu;
+			for (size_t i = 0; i + 1 < n; ++i) {
+				if (t[i] < t[i + 1]) {
+					mu.push_back(i);
+					x_.push_back(t[i]);
+				}
+			}
+			x_.push_back(t[n - 1]);
+			m_ = mu.size();
+
+			// c[j] = p^(j)(x[l])/j!
+			c_.resize((k_ + 1)*m_);
+			for (size_t l = 0; l < m_; ++l) {
+				T B[curves::basis_spline::max_order + 1];
+				T fact(1);
+
+				for (size_t r = 0; r <= k_; ++r) {
+					size_t kr = k_ - r;
+					T p(0);
+
+					curves::basis_spline::values(kr, n, t, mu[l], static_cast<T>(x_[l]), B);
+					for (size_t q = 0; q <= kr; ++q) {
+						if (mu[l] + q >= kr && mu[l] + q - kr < d[r].size())
+							p += d[r][mu[l] + q - kr]*B[q];
+					}
+
+					if (r > 0)
+						fact *= r;
+					c_[r*m_ + l] = p/fact;
+				}
+			}
+
+			dc_.resize(k_*m_);
+			for (size_t j = 0; j < k_; ++j)
+				for (size_t l = 0; l < m_; ++l)
+					dc_[j*m_ + l] = (j + 1)*c_[(j + 1)*m_ + l];
+
+			ic_.resize((k_ + 2)*m_);
+			for (size_t j = 0; j <= k_; ++j)
+				for (size_t l = 0; l < m_; ++l)
+					ic_[(j + 1)*m_ + l] = c_[j*m_ + l]/(j + 1);
+			T I(0);
+			for (size_t l = 0; l < m_; ++l) {
+				ic_[l] = I;
+				I = horner(k_ + 2, &ic_[0], l, static_cast<T>(x_[l + 1] - x_[l]));
+			}
+		}
+		~pp_form()
+		{ }
+
+		size_t order(void) const
+		{
+			return k_;
+		}
+		// number of intervals
+		size_t size(void) const
+		{
+			return m_;
+		}
+		const U* breakpoints(void) const
+		{
+			return &x_[0];
+		}
+		// coefficients of (x - x[l])^j for l < size()
+		const T* coefficients(size_t j) const
+		{
+			ensure (j <= k_);
+
+			return &c_[j*m_];
+		}
+
+		T operator()(T x) const
+		{
+			size_t l = interval(x);
+
+			return l == m_ ? T(0) : horner(k_ + 1, &c_[0], l, x - x_[l]);
+		}
+		T derivative(T x) const
+		{
+			size_t l = interval(x);
+
+			return l == m_ || k_ == 0 ? T(0) : horner(k_, &dc_[0], l, x - x_[l]);
+		}
+		// integral from x[0] to x
+		T integral(T x) const
+		{
+			size_t l = interval(x);
+
+			return l == m_ ? T(0) : horner(k_ + 2, &ic_[0], l, x - x_[l]);
+		}
+	};
+
+} // namespace curves
@@ -2,6 +2,7 @@
 // Copyright (c) 2011-2012 KALX, LLC. All rights reserved. No warranty made.
 #pragma once
 #include <vector>
+#include "../include/timer.h"
 #include "bootstrap.h"
 
 namespace curves {
@@ -33,42 +34,226 @@ namespace curves {
 
 namespace pwflat {
 
+	// Bootstrapped curve that remembers its instruments so a quote
+	// change only re-bootstraps the knots at and after the instrument.
 	template<class T = double, class F = double>
 	class yield_curve {
+		struct quote {
+			std::vector<T> u;
+			std::vector<F> c;
+			F p;
+			quote(size_t m, const T* u_, const F* c_, F p_)
+				: u(u_, u_ + m), c(c_, c_ + m), p(p_)
+			{ }
+		};
 		std::vector<T> t_;
 		std::vector<F> f_;
+		std::vector<F> I_; // integral of f_ from 0 to t_[i]
+		std::vector<quote> q_; // instrument for knot n0_ + k
+		size_t n0_; // knots not bootstrapped
+
+		// integral from 0 to u using the first k knots and forward _f past them
+		F integral(size_t k, T u, F _f) const
+		{
+			size_t i = std::lower_bound(t_.begin(), t_.begin() + k, u) - t_.begin(); // u <= t[i]
+
+			if (i == 0)
+				return static_cast<F>((k ? f_[0] : _f)*u);
+
+			return I_[i - 1] + static_cast<F>((i == k ? _f : f_[i])*(u - t_[i - 1]));
+		}
+		// forward for knot k given knots before k
+		F solve(size_t k, F guess) const
+		{
+			const quote& q = q_[k - n0_];
+			size_t m = q.u.size();
+			const T* u = &q.u[0];
+			const F* c = &q.c[0];
+
+			ensure (m && (k == 0 || u[m - 1] > t_[k - 1]));
+
+			// closed form cash deposit and forward rate agreement
+			curves::pwflat::forward<T,F> f = k ? curves::pwflat::forward<T,F>(k, &t_[0], &f_[0]) : curves::pwflat::forward<T,F>();
+			if (m == 1) {
+				ensure (q.p > 0);
+
+				return f.bootstrap1(u[0], c[0]/q.p);
+			}
+			if (m == 2 && q.p == 0)
+				return f.bootstrap2(u[0], c[0], u[1], c[1]);
+
+			// cash flows up to t0 are discounted from the cache once
+			T t0 = k ? t_[k - 1] : 0;
+			F D0 = exp(-(k ? I_[k - 1] : 0));
+			const T* u0 = std::upper_bound(u, u + m, t0); // t0 < *u0
+			size_t j0 = u0 - u;
+
+			F a = -q.p;
+			for (size_t j = 0; j < j0; ++j)
+				a += c[j]*exp(-integral(k, u[j], 0));
+
+			auto pv = [=](F _f) -> F
+			{
+				F v = a;
+
+				for (size_t j = j0; j < m; ++j)
+					v += c[j]*D0*exp(-_f*(u[j] - t0));
+
+				return v;
+			};
+			auto dpv = [=](F _f) -> F
+			{
+				F dv(0);
+
+				for (size_t j = j0; j < m; ++j)
+					dv -= (u[j] - t0)*c[j]*D0*exp(-_f*(u[j] - t0));
+
+				return dv;
+			};
+
+			return numerical::root1d::newton(guess, pv, dpv);
+		}
+		// bootstrap knots k, ..., n-1
+		void bootstrap(size_t k)
+		{
+			for (; k < t_.size(); ++k) {
+				f_[k] = solve(k, f_[k] ? f_[k] : (k ? f_[k - 1] : 0));
+				I_[k] = (k ? I_[k - 1] : 0) + f_[k]*(t_[k] - (k ? t_[k - 1] : 0));
+			}
+		}
+		yield_curve& push_back(size_t m, const T* u, const F* c, F p)
+		{
+			q_.push_back(quote(m, u, c, p));
+			t_.push_back(u[m - 1]);
+			f_.push_back(0);
+			I_.push_back(0);
+			bootstrap(t_.size() - 1);
+
+			return *this;
+		}
 	public:
 		yield_curve(size_t n = 0, const T* t = 0, const F* f = 0)
-			: t_(t, t + n), f_(f, f + n)
-		{ }
+			: t_(t, t + n), f_(f, f + n), I_(n), n0_(n)
+		{
+			for (size_t i = 0; i < n; ++i)
+				I_[i] = (i ? I_[i - 1] : 0) + f_[i]*(t_[i] - (i ? t_[i - 1] : 0));
+		}
 		// use this to call value, spot, discount, etc.
-		curves::pwflat::forward<T,F> forward(void)
+		curves::pwflat::forward<T,F> forward(void) const
 		{
 			return t_.size() ? curves::pwflat::forward<T,F>(t_.size(), &t_[0], &f_[0]) : curves::pwflat::forward<T,F>();
 		}
-		// cash deposit
-		yield_curve& add(T t, F c)
+		// discount D[j] at sorted times u[j], j < m
+		void discount(size_t m, const T* u, F* D) const
+		{
+			forward().discount(m, u, D);
+		}
+		// present values pv[k] of instruments k < l having m[k] cash flows
+		void present_value(size_t l, const size_t* m, const T* u, const F* c, F* pv) const
+		{
+			forward().present_value(l, m, u, c, pv);
+		}
+		// number of instruments added
+		size_t instruments(void) const
+		{
+			return q_.size();
+		}
+		// price of instrument k
+		F price(size_t k) const
 		{
-			f_.push_back(forward().bootstrap1(t, c));
-			t_.push_back(t);
+			ensure (k < q_.size());
 
-			return *this;
+			return q_[k].p;
+		}
+		// cash deposit of 1
+		yield_curve& add(T t, F c)
+		{
+			return push_back(1, &t, &c, 1);
 		}
 		// forward rate agreement
 		yield_curve& add(T t0, F c0, T t1, F c1)
 		{
-			f_.push_back(forward().bootstrap2(t0, c0, t1, c1));
-			t_.push_back(t1);
+			T u[] = {t0, t1};
+			F c[] = {c0, c1};
 
-			return *this;
+			return push_back(2, u, c, 0);
 		}
-		// general cash flows
+		// general cash flows having present value p
 		yield_curve& add(size_t m, const T* u, const F* c, F p = 0)
 		{
-			f_.push_back(forward().bootstrap(m, u, c, p));
-			t_.push_back(u[m-1]);
+			return push_back(m, u, c, p);
+		}
 
-			return *this;
+		// Sensitivities d(pv)/d(p[k]) of sorted cash flows to the price of each instrument k.
+		// Solves J' lambda = d(pv)/df by back substitution, where J[j][i] = d(pv_j)/d(f[i])
+		// is lower triangular, so each instrument is visited once from last to first.
+		// Row j is one adjoint sweep over the flows of instrument j and is consumed as it
+		// is produced, so this takes O(n^2 + m + number of instrument cash flows) for n knots.
+		// If instrument k is quoted by a rate r instead of a price then
+		// d(pv)/dr = -lambda[k] sum_j dc_j/dr D(u_j).
+		std::vector<F> sensitivity(size_t m, const T* u, const F* c) const
+		{
+			curves::pwflat::forward<T,F> f = forward();
+			std::vector<F> lambda(t_.size() + 1, 0);
+			std::vector<F> J(t_.size() + 1, 0); // row j, zeroed as it is consumed
+
+			f.present_value_adjoint(m, u, c, &lambda[0]);
+
+			for (size_t j = t_.size(); j-- > n0_; ) {
+				const quote& q = q_[j - n0_];
+
+				// cash flows of instrument j end at t[j] so only J[0], ..., J[j] are set
+				f.present_value_adjoint(q.u.size(), &q.u[0], &q.c[0], &J[0]);
+				ensure (J[j] != 0);
+
+				lambda[j] /= J[j];
+				J[j] = 0;
+				for (size_t i = 0; i < j; ++i) {
+					lambda[i] -= J[i]*lambda[j];
+					J[i] = 0;
+				}
+			}
+
+			return std::vector<F>(lambda.begin() + n0_, lambda.end() - 1);
+		}
+
+		// forwards at knots first, first + 1, ... after an update and seconds taken
+		struct update_result {
+			size_t first;
+			std::vector<F> forward;
+			double elapsed;
+		};
+		// replace cash flows and price of instrument k and re-bootstrap from its knot on
+		update_result update(size_t k, size_t m, const T* u, const F* c, F p = 0)
+		{
+			utility::timer timer;
+			timer.start();
+
+			ensure (k < q_.size());
+			size_t i = n0_ + k;
+			ensure (m && (i == 0 || u[m - 1] > t_[i - 1]));
+			ensure (i + 1 == t_.size() || u[m - 1] < t_[i + 1]);
+
+			q_[k] = quote(m, u, c, p);
+			t_[i] = u[m - 1];
+			bootstrap(i);
+
+			timer.stop();
+
+			update_result r;
+			r.first = i;
+			r.forward.assign(f_.begin() + i, f_.end());
+			r.elapsed = timer.elapsed();
+
+			return r;
+		}
+		// new price of instrument k
+		update_result update(size_t k, F p)
+		{
+			ensure (k < q_.size());
+			const quote q = q_[k];
+
+			return update(k, q.u.size(), &q.u[0], &q.c[0], p);
 		}
 	};
 
@@ -4,9 +4,10 @@
 
 #include "holiday.h"
 
-#define HOLIDAY_DECL int y, m, d; t.localtime(&y, &m, &d); datetime::date t0(y, m, d);
-#define HOLIDAY(h) (t0 == holiday::h(y))
-#define HOLIDAY_DATE(y,m,d) (t0 == datetime::date(y,m,d))
+// holidays are looked up in tables computed at compile time
+#define HOLIDAY_DECL int z = t.days(), y = datetime::year_from_days(z);
+#define HOLIDAY(h) (z == holiday::lookup<holiday::serial::h>(y))
+#define HOLIDAY_DATE(y,m,d) (z == datetime::days_from_civil(y,m,d))
 
 namespace datetime {
 namespace calendar {
@@ -0,0 +1,302 @@
+// calendar_file.h - bitmap calendars in memory mapped binary files
+// Copyright (c) 2011 KALX, LLC. All rights reserved. No warranty is made.
+// Processes that map the same file share one copy of the bitmaps
+// in the page cache. The layout is native (little) endian:
+//   header  "KXCAL\0\0\0", uint32 version, uint32 count
+//   entry   char name[16], int32 y0, y1, d0, n, uint64 offset  (count of them)
+//   bitmaps uint64 holiday[(n + 63)/64] then bday[(n + 63)/64] at offset
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "calendar.h"
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace datetime {
+
+	// read only view of an entire file
+	class mapped_file {
+		const char* p_;
+		size_t n_;
+
+		mapped_file(const mapped_file&);
+		mapped_file& operator=(const mapped_file&);
+	public:
+		explicit mapped_file(const std::string& path)
+			: p_(0), n_(0)
+		{
+#ifdef _WIN32
+			HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+			ensure (h != INVALID_HANDLE_VALUE);
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(h, &size) || size.QuadPart == 0) {
+				CloseHandle(h);
+				ensure (!"mapped_file: empty file");
+			}
+			n_ = static_cast<size_t>(size.QuadPart);
+
+			HANDLE m = CreateFileMappingA(h, 0, PAGE_READONLY, 0, 0, 0);
+			CloseHandle(h);
+			ensure (m != 0);
+
+			// the view keeps the mapping open
+			p_ = static_cast<const char*>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+			CloseHandle(m);
+			ensure (p_ != 0);
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			ensure (fd != -1);
+
+			struct stat st;
+			if (fstat(fd, &st) != 0 || st.st_size == 0) {
+				close(fd);
+				ensure (!"mapped_file: empty file");
+			}
+			n_ = static_cast<size_t>(st.st_size);
+
+			// the mapping keeps the file open
+			void* p = mmap(0, n_, PROT_READ, MAP_SHARED, fd, 0);
+			close(fd);
+			ensure (p != MAP_FAILED);
+			p_ = static_cast<const char*>(p);
+#endif
+		}
+		~mapped_file()
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(p_);
+#else
+			munmap(const_cast<char*>(p_), n_);
+#endif
+		}
+
+		const char* data(void) const
+		{
+			return p_;
+		}
+		size_t size(void) const
+		{
+			return n_;
+		}
+	};
+
+	// calendars in a mapped calendar file
+	class calendar_file {
+		struct header {
+			char magic[8];
+			uint32_t version;
+			uint32_t count;
+		};
+		struct entry {
+			char name[16];
+			int32_t y0, y1, d0, n;
+			uint64_t offset;
+		};
+		static const char* magic(void)
+		{
+			return "KXCAL\0\0";
+		}
+		static const uint32_t version = 1;
+
+		std::vector<bitmap_calendar> cals_;
+	public:
+		// calendar in calendar.h to use outside of the years in the file
+		static holiday_calendar builtin(const std::string& name)
+		{
+			static const struct {
+				const char* name;
+				bool (*cal)(const date&);
+			} cals[] = {
+				{ "BMA", calendar::BMA },
+				{ "CMM", calendar::CMM },
+				{ "EUR", calendar::EUR },
+				{ "GBP", calendar::GBP },
+				{ "LnB", calendar::LnB },
+				{ "NER", calendar::NER },
+				{ "NYB", calendar::NYB },
+				{ "NYS", calendar::NYS },
+			};
+
+			for (size_t i = 0; i < sizeof(cals)/sizeof(*cals); ++i) {
+				if (name == cals[i].name)
+					return cals[i].cal;
+			}
+
+			return CALENDAR_NONE;
+		}
+
+		// write named calendars to path
+		// The file is written beside path and renamed over it so processes
+		// that have the old file mapped keep seeing it.
+		static void write(const std::string& path, const std::vector<bitmap_calendar>& cals)
+		{
+			header h;
+			memcpy(h.magic, magic(), sizeof(h.magic));
+			h.version = version;
+			h.count = static_cast<uint32_t>(cals.size());
+
+			std::vector<entry> e(cals.size());
+			uint64_t offset = sizeof(header) + cals.size()*sizeof(entry);
+			for (size_t i = 0; i < cals.size(); ++i) {
+				const bitmap_calendar::data& c = *cals[i].p_;
+				ensure (0 < c.name.size() && c.name.size() < sizeof(e[i].name));
+
+				memset(e[i].name, 0, sizeof(e[i].name));
+				memcpy(e[i].name, c.name.data(), c.name.size());
+				e[i].y0 = c.y0;
+				e[i].y1 = c.y1;
+				e[i].d0 = c.d0;
+				e[i].n = c.n;
+				e[i].offset = offset;
+				offset += 2*c.nw*sizeof(uint64_t);
+			}
+
+			std::string tmp = path + ".tmp";
+			{
+				std::ofstream os(tmp.c_str(), std::ios::binary | std::ios::trunc);
+				ensure (os);
+				os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+				if (e.size())
+					os.write(reinterpret_cast<const char*>(&e[0]), e.size()*sizeof(entry));
+				for (size_t i = 0; i < cals.size(); ++i) {
+					const bitmap_calendar::data& c = *cals[i].p_;
+
+					os.write(reinterpret_cast<const char*>(c.holiday), c.nw*sizeof(uint64_t));
+					os.write(reinterpret_cast<const char*>(c.bday), c.nw*sizeof(uint64_t));
+				}
+				os.close();
+				ensure (os);
+			}
+
+#ifdef _WIN32
+			ensure (MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING));
+#else
+			ensure (0 == std::rename(tmp.c_str(), path.c_str()));
+#endif
+		}
+
+		// map path and check its layout
+		explicit calendar_file(const std::string& path)
+		{
+			std::shared_ptr<const mapped_file> f(new mapped_file(path));
+			const char* p = f->data();
+			size_t size = f->size();
+
+			ensure (size >= sizeof(header));
+			const header& h = *reinterpret_cast<const header*>(p);
+			ensure (0 == memcmp(h.magic, magic(), sizeof(h.magic)));
+			ensure (h.version == version);
+			ensure (sizeof(header) + h.count*sizeof(entry) <= size);
+
+			const entry* e = reinterpret_cast<const entry*>(p + sizeof(header));
+			for (uint32_t i = 0; i < h.count; ++i) {
+				ensure (e[i].name[sizeof(e[i].name) - 1] == 0);
+				ensure (e[i].y0 < e[i].y1);
+				ensure (e[i].d0 == days_from_civil(e[i].y0, 1, 1));
+				ensure (e[i].n == days_from_civil(e[i].y1, 1, 1) - e[i].d0);
+
+				std::shared_ptr<bitmap_calendar::data> c(new bitmap_calendar::data);
+				c->name = e[i].name;
+				c->y0 = e[i].y0;
+				c->y1 = e[i].y1;
+				c->d0 = e[i].d0;
+				c->n = e[i].n;
+				c->nw = (c->n + 63)/64;
+				ensure (e[i].offset%sizeof(uint64_t) == 0);
+				ensure (e[i].offset + 2*c->nw*sizeof(uint64_t) <= size);
+				c->holiday = reinterpret_cast<const uint64_t*>(p + e[i].offset);
+				c->bday = c->holiday + c->nw;
+				c->file = f;
+				c->cal = builtin(c->name);
+				bitmap_calendar::index(*c);
+
+				cals_.push_back(bitmap_calendar(std::shared_ptr<const bitmap_calendar::data>(c)));
+			}
+		}
+
+		size_t size(void) const
+		{
+			return cals_.size();
+		}
+		const bitmap_calendar& operator[](size_t i) const
+		{
+			return cals_[i];
+		}
+	};
+
+	namespace detail {
+
+		inline std::mutex& calendar_mutex(void)
+		{
+			static std::mutex mutex;
+
+			return mutex;
+		}
+		inline std::map<std::string, bitmap_calendar>& calendar_registry(void)
+		{
+			static std::map<std::string, bitmap_calendar> registry;
+
+			return registry;
+		}
+
+	} // namespace detail
+
+	// register cal under its name, replacing any calendar with that name
+	inline void register_calendar(const bitmap_calendar& cal)
+	{
+		ensure (!cal.name().empty());
+
+		std::lock_guard<std::mutex> lock(detail::calendar_mutex());
+		std::map<std::string, bitmap_calendar>& r = detail::calendar_registry();
+
+		auto i = r.find(cal.name());
+		if (i != r.end())
+			i->second = cal;
+		else
+			r.insert(std::make_pair(cal.name(), cal));
+	}
+	inline bool has_calendar(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(detail::calendar_mutex());
+
+		return detail::calendar_registry().count(name) != 0;
+	}
+	inline bitmap_calendar find_calendar(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(detail::calendar_mutex());
+		std::map<std::string, bitmap_calendar>& r = detail::calendar_registry();
+
+		auto i = r.find(name);
+		ensure (i != r.end());
+
+		return i->second;
+	}
+
+	// register every calendar in a calendar file and return how many there are
+	inline size_t load_calendars(const std::string& path)
+	{
+		calendar_file f(path);
+
+		for (size_t i = 0; i < f.size(); ++i)
+			register_calendar(f[i]);
+
+		return f.size();
+	}
+
+} // namespace datetime
@@ -3,6 +3,8 @@
 #pragma once
 
 #include <ctype.h>
+#include <stddef.h>
+#include "dt.h"
 
 namespace cmegroup {
 
@@ -77,4 +79,101 @@ namespace cmegroup {
 		return futures_code_month_table[i];
 	}
 
+	/* futures contract from a symbol like EDZ4 or GEH25 */
+	struct futures_symbol {
+		char root[4];  // NUL terminated, at most 3 characters
+		int month;     // JAN = 1, 0 if not a valid symbol
+		int year;      // four digit year
+		int expiry;    // IMM date, third Wednesday, as days since 1970-01-01
+	};
+
+	/* year on or after base with the same last digits */
+	inline int
+	futures_year(int digits, int base, int modulus)
+	{
+		int y = base - base%modulus + digits;
+
+		return y < base ? y + modulus : y;
+	}
+
+	/* Parse symbol in [b, e) using base as the first possible year for one or two digit years.
+	   Returns false and sets s.month to 0 if it is not root + month code + year. */
+	inline bool
+	futures_parse(const char* b, const char* e, futures_symbol& s, int base)
+	{
+		s.root[0] = 0;
+		s.month = 0;
+		s.year = 0;
+		s.expiry = 0;
+
+		// year digits from the end
+		const char* p = e;
+		int year = 0, modulus = 1;
+		while (p > b && e - p < 2 && isdigit(static_cast<unsigned char>(p[-1]))) {
+			--p;
+			year += modulus*(*p - '0');
+			modulus *= 10;
+		}
+		if (p == e || p - b < 2 || p - b > 4)
+			return false;
+
+		int month = futures_code_month(p[-1]);
+		if (month == 0)
+			return false;
+
+		size_t n = p - 1 - b;
+		for (size_t i = 0; i < n; ++i) {
+			if (!isalnum(static_cast<unsigned char>(b[i])))
+				return false;
+			s.root[i] = b[i];
+		}
+		s.root[n] = 0;
+		s.month = month;
+		s.year = futures_year(year, base, modulus);
+		s.expiry = datetime::imm_date(s.year, s.month);
+
+		return true;
+	}
+
+	/* Write root + month code + last digits of the year to buf and return the length.
+	   buf needs room for 3 + 1 + digits characters, no NUL is written. */
+	inline size_t
+	futures_format(const futures_symbol& s, char* buf, int digits = 1)
+	{
+		size_t n = 0;
+
+		for (; n < sizeof(s.root) && s.root[n]; ++n)
+			buf[n] = s.root[n];
+		buf[n++] = static_cast<char>(futures_month_code(s.month));
+		for (int i = digits, y = s.year; i > 0; --i, y /= 10)
+			buf[n + i - 1] = static_cast<char>('0' + y%10);
+
+		return n + digits;
+	}
+
+	/* Parse symbols in buf separated by sep into s[0], s[1], ... and return how many.
+	   Stops after n symbols. Invalid symbols have month 0. */
+	inline size_t
+	futures_parse(const char* buf, size_t len, futures_symbol* s, size_t n, int base, char sep = '\n')
+	{
+		const char* e = buf + len;
+		size_t i = 0;
+
+		while (buf < e && i < n) {
+			const char* b = buf;
+			while (buf < e && *buf != sep)
+				++buf;
+
+			// skip empty lines and carriage returns
+			const char* end = buf > b && buf[-1] == '\r' ? buf - 1 : buf;
+			if (end > b)
+				futures_parse(b, end, s[i++], base);
+
+			if (buf < e)
+				++buf;
+		}
+
+		return i;
+	}
+
 } // namespace cmegroup
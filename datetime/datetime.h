@@ -8,7 +8,12 @@
 #include <algorithm>
 #include <functional>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
+#include <stdint.h>
 #include "dt.h"
 
 namespace datetime {
@@ -86,24 +91,171 @@ typedef enum roll_convention {
 	ROLL_MAX
 };
 
+typedef enum calendar_join {
+	CALENDAR_UNION,        // holiday in any calendar
+	CALENDAR_INTERSECTION, // holiday in all calendars
+	CALENDAR_JOIN_MAX
+};
+
 class date;
 typedef std::function<bool(const date&)> holiday_calendar;
 #define CALENDAR_NONE [](const date&) { return false; }
 
+// Holidays and business days of a holiday_calendar precomputed as bitmaps
+// over the years [y0, y1). Copies share the bitmaps so it is cheap to
+// use as a holiday_calendar. Days outside of the range call the calendar.
+class bitmap_calendar {
+	friend class calendar_file;
+
+	struct data {
+		std::string name;
+		int y0, y1;
+		int d0, n; // first serial day and number of days
+		size_t nw; // words in each bitmap
+		const uint64_t* holiday; // in storage or a mapped file
+		const uint64_t* bday;
+		std::vector<uint64_t> storage;
+		std::shared_ptr<const void> file; // keeps mapped bitmaps alive
+		std::vector<int> rank;   // business days before each word
+		std::vector<int> select; // word containing business day 64*j
+		holiday_calendar cal;
+	};
+	std::shared_ptr<const data> p_;
+
+	bitmap_calendar(const std::shared_ptr<const data>& p)
+		: p_(p)
+	{ }
+
+	// holiday and business day bitmaps for n days from d0 in storage
+	static uint64_t* allocate(data& p, int d0, int n)
+	{
+		p.d0 = d0;
+		p.n = n;
+		p.nw = (n + 63)/64;
+		p.storage.assign(2*p.nw, 0);
+		p.holiday = &p.storage[0];
+		p.bday = p.holiday + p.nw;
+
+		return &p.storage[0];
+	}
+	// rank and select tables from business days
+	static void index(data& p);
+	// 64 bits starting at bit i of nw words
+	static uint64_t bits(const uint64_t* b, size_t nw, size_t i)
+	{
+		size_t w = i >> 6, s = i & 63;
+		uint64_t lo = w < nw ? b[w] >> s : 0;
+		uint64_t hi = s && w + 1 < nw ? b[w + 1] << (64 - s) : 0;
+
+		return lo | hi;
+	}
+
+	static bool test(const uint64_t* b, int i)
+	{
+		return 0 != ((b[i >> 6] >> (i & 63)) & 1);
+	}
+	static int popcount(uint64_t x)
+	{
+#if defined(__GNUC__)
+		return __builtin_popcountll(x);
+#else
+		x = x - ((x >> 1) & 0x5555555555555555ULL);
+		x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+		return static_cast<int>((x*0x0101010101010101ULL) >> 56);
+#endif
+	}
+	bool in_range(int d) const
+	{
+		return p_->d0 <= d && d < p_->d0 + p_->n;
+	}
+	// business days in [d0, d0 + i) for i <= n
+	int rank(int i) const
+	{
+		int w = i >> 6, b = i & 63;
+
+		return p_->rank[w] + (b ? popcount(p_->bday[w] << (64 - b)) : 0);
+	}
+	// offset from d0 of business day k, 0 <= k < rank(n)
+	int select(int k) const
+	{
+		size_t w = p_->select[k >> 6];
+		while (p_->rank[w + 1] <= k)
+			++w;
+
+		// clear the lower business days in the word
+		uint64_t x = p_->bday[w];
+		for (int j = k - p_->rank[w]; j > 0; --j)
+			x &= x - 1;
+
+		return static_cast<int>(64*w) + popcount((x & (~x + 1)) - 1);
+	}
+public:
+	bitmap_calendar(const holiday_calendar& cal, int y0 = 1970, int y1 = 2100, const std::string& name = "");
+
+	// Calendar of holidays in any or all of the calendars over the common years.
+	// Joins of named calendars in use are cached by the operation and the component calendars.
+	static bitmap_calendar join(const std::vector<bitmap_calendar>& cals, calendar_join op = CALENDAR_UNION);
+	static bitmap_calendar join(const bitmap_calendar& c0, const bitmap_calendar& c1, calendar_join op = CALENDAR_UNION)
+	{
+		std::vector<bitmap_calendar> c;
+
+		c.push_back(c0);
+		c.push_back(c1);
+
+		return join(c, op);
+	}
+
+	const std::string& name() const
+	{
+		return p_->name;
+	}
+	int first_year() const
+	{
+		return p_->y0;
+	}
+	int last_year() const
+	{
+		return p_->y1;
+	}
+	// shared by copies of this calendar and by nothing else while held
+	std::shared_ptr<const void> identity() const
+	{
+		return p_;
+	}
+
+	// serial days since 1970-01-01
+	bool is_holiday(int d) const;
+	bool is_bday(int d) const;
+	// number of business days in [d0, d1)
+	int count(int d0, int d1) const;
+	// n-th business day after d if n > 0 or before d if n < 0
+	int offset(int d, int n) const;
+
+	// holiday_calendar
+	bool operator()(const date& d) const;
+};
+
 class date {
 	// returns true if date is a holiday
 private:
-	// UTC
-	time_t t_;
+	// local wall clock time as days since 1970-01-01 and seconds of the day
+	int d_, s_;
+
+	// normalize seconds into [0, SECS_PER_DAY)
+	void normalize(void)
+	{
+		int d = floor_div(s_, 86400);
+
+		d_ += d;
+		s_ -= d*86400;
+	}
 
 protected:
 	date& incr(int days)
 	{
-		int y, m, d, h, n, s;
-
-		localtime(&y, &m, &d, &h, &n, &s);
-		d += days;
-		maketime(y, m, d, h, n, s);
+		d_ += days;
 
 		return *this;
 	}
@@ -111,18 +263,29 @@ protected:
 public:
 	// invalid date
 	date()
-		: t_(-1)
+		: d_(std::numeric_limits<int>::min()), s_(0)
 	{
 	}
+	// UTC
 	explicit date(time_t t)
-		: t_(t)
 	{
+		struct tm tm;
+		bool ok = datetime::localtime(t, &tm);
+
+		ensure (ok);
+		(void)ok; // ensure may be empty
+		maketime(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+			tm.tm_hour, tm.tm_min, tm.tm_sec);
 		ensure(is_valid());
 	}
 	// Excel time
 	explicit date(double t)
 	{
-		t_ = excel2time_t(t);
+		double d = floor(t);
+
+		d_ = static_cast<int>(d - EXCEL_EPOCH);
+		s_ = static_cast<int>(0.5 + (t - d)*SECS_PER_DAY);
+		normalize();
 		ensure (is_valid());
 	}
 
@@ -140,13 +303,15 @@ public:
 	}
 
 	date(const date& d)
-		: t_(d.t_)
+		: d_(d.d_), s_(d.s_)
     {
     }
     date& operator=(const date& d)
     {
-        if (this != &d)
-            t_ = d.t_;
+        if (this != &d) {
+            d_ = d.d_;
+            s_ = d.s_;
+        }
 
         return *this;
     }
@@ -155,25 +320,51 @@ public:
 
 	bool operator==(const date& d) const
 	{
-		return t_ == d.t_;
+		return d_ == d.d_ && s_ == d.s_;
 	}
 	bool operator<(const date& d) const
 	{
-		return t_ < d.t_;
+		return d_ < d.d_ || (d_ == d.d_ && s_ < d.s_);
 	}
 
 	bool is_valid() const
 	{
-		return t_ != -1;
+		return d_ != std::numeric_limits<int>::min();
 	}
 
+	// days since 1970-01-01 of the wall clock date
+	int days() const
+	{
+		return d_;
+	}
+	// seconds since midnight
+	int seconds() const
+	{
+		return s_;
+	}
+
+	// UTC using the C library time zone rules
 	time_t time() const
 	{
-		return t_;
+		int y, m, d, h, n, s;
+
+		localtime(&y, &m, &d, &h, &n, &s);
+
+		struct tm t;
+
+		t.tm_year = y - 1900;
+		t.tm_mon  = m - 1;
+		t.tm_mday = d;
+		t.tm_hour = h;
+		t.tm_min  = n;
+		t.tm_sec  = s;
+		t.tm_isdst = -1;
+
+		return ::mktime(&t);
 	}
 	double excel() const
 	{
-		return time_t2excel(t_); 
+		return EXCEL_EPOCH + d_ + s_/SECS_PER_DAY; 
 	}
 
 	// break out wall clock time
@@ -181,55 +372,47 @@ public:
 				int* ph = 0, int* pn = 0, int* ps = 0,
 				int* pwday = 0, int* pyday = 0, int* pisdst = 0) const
 	{
-		struct tm* ptm = ::localtime(&t_); // !!!not thread safe
+		ensure (is_valid());
 
-		ensure (ptm);
+		int y;
+		civil_from_days(d_, &y, pm, pd);
 
 		if (py) 
-			*py = ptm->tm_year + 1900;
-		if (pm) 
-			*pm = ptm->tm_mon + 1;
-		if (pd) 
-			*pd = ptm->tm_mday;
+			*py = y;
 		if (ph) 
-			*ph = ptm->tm_hour;
+			*ph = s_/3600;
 		if (pn) 
-			*pn = ptm->tm_min;
+			*pn = (s_/60)%60;
 		if (ps) 
-			*ps = ptm->tm_sec;
+			*ps = s_%60;
 		if (pwday) 
-			*pwday = ptm->tm_wday;
+			*pwday = weekday_from_days(d_);
 		if (pyday) 
-			*pyday = ptm->tm_yday;
-		if (pisdst) 
-			*pisdst = ptm->tm_isdst;
+			*pyday = d_ - days_from_civil(y, 1, 1);
+		if (pisdst) {
+			// only place the C library time zone rules are needed
+			struct tm tm;
+			time_t t = time();
+
+			*pisdst = t != -1 && datetime::localtime(t, &tm) ? tm.tm_isdst : -1;
+		}
 	}
 
-	// wall clock to UTC time_t
+	// wall clock time, out of range fields are normalized like mktime
 	void maketime(int y, int m, int d, int h = 0, int n = 0, int s = 0)
 	{
-		struct tm t;
+		y += floor_div(m - 1, 12);
+		m -= 12*floor_div(m - 1, 12);
 
-		t.tm_year = y - 1900;
-		t.tm_mon  = m - 1;
-		t.tm_mday = d;
-		t.tm_hour = h;
-		t.tm_min  = n;
-		t.tm_sec  = s;
-		t.tm_isdst = -1;
-
-		t_ = ::mktime(&t);
-		ensure(is_valid());
+		d_ = days_from_civil(y, m, 1) + d - 1;
+		s_ = h*3600 + n*60 + s;
+		normalize();
 	}
 
 	// get day of week, Sunday = 0
 	int weekday() const
 	{
-		int wday;
-		
-		localtime(0, 0, 0, 0, 0, 0, &wday);
-
-		return wday;
+		return weekday_from_days(d_);
 	}
 	// get day of year, Jan 1 = 0
 	int yearday() const
@@ -302,9 +485,7 @@ public:
 	// True if date is a leap year.
 	int is_leap() const
 	{
-		int y = year();
-
-		return y%4 == 0 && (y%100 != 0 || y%400 == 0); 
+		return is_leap_year(year());
 	}
 	// date in YYYYMMDD format
 	int ymd() const
@@ -329,7 +510,9 @@ public:
 	// Assumes holidays are sorted.
 	bool is_holiday(const holiday_calendar& cal = CALENDAR_NONE) const
 	{
-		return cal(*this);
+		const bitmap_calendar* b = cal.target<bitmap_calendar>();
+
+		return b ? b->is_holiday(d_) : cal(*this);
 	}
 
 	bool is_workday() const
@@ -341,12 +524,14 @@ public:
 	// business day
 	bool is_bday(const holiday_calendar& cal = CALENDAR_NONE) const
 	{
-		return is_workday() && !is_holiday(cal);
+		const bitmap_calendar* b = cal.target<bitmap_calendar>();
+
+		return b ? b->is_bday(d_) : is_workday() && !is_holiday(cal);
 	}
-	// wrapper for ANSI C difftime() function
+	// difference in wall clock seconds
 	double difftime(const date& d) const
 	{
-		return ::difftime(t_, d.time()); 
+		return (d_ - d.d_)*SECS_PER_DAY + (s_ - d.s_); 
 	}
 
 	// difference in seconds between dates
@@ -357,7 +542,7 @@ public:
 
 	int diffdays(const date& d) const
 	{
-		return static_cast<int>((difftime(d) + SECS_PER_DAY/2)/SECS_PER_DAY);
+		return static_cast<int>(floor((difftime(d) + SECS_PER_DAY/2)/SECS_PER_DAY));
 	}
 
 	// difference in years between dates
@@ -367,7 +552,11 @@ public:
 	}
 	date& addyears(double y)
 	{
-		t_ += static_cast<time_t>(y*SECS_PER_YEAR);
+		double s = s_ + floor(0.5 + y*SECS_PER_YEAR);
+		double d = floor(s/SECS_PER_DAY);
+
+		d_ += static_cast<int>(d);
+		s_ = static_cast<int>(s - d*SECS_PER_DAY);
 
 		return *this;
 	}
@@ -383,6 +572,14 @@ public:
 	// number of business days between dates
 	int diffworkdays(date d1, const holiday_calendar& cal = CALENDAR_NONE) const
 	{
+		const bitmap_calendar* b = cal.target<bitmap_calendar>();
+		if (b) {
+			// business days in [min, max] like excel
+			int n = d_ < d1.d_ ? b->count(d_, d1.d_ + 1) : b->count(d1.d_, d_ + 1);
+
+			return d_ < d1.d_ ? -n : n;
+		}
+
 		int count;
 		int y, m, d;
 		
@@ -556,7 +753,7 @@ public:
 				}
 				break;
 			default:
-				t_ = (time_t)-1;
+				*this = date();
 		}
 
 		return *this;
@@ -564,92 +761,70 @@ public:
 	// move a date to n-th week day 
 	date& imm(int nth, day_of_week day)
 	{
-		int y, m, d, h, n, s, wday;
-		
 		ensure (nth >= 0);
 
-		localtime(&y, &m, &d, &h, &n, &s, &wday);
-		if (nth == 0) {
-			// increment to day of week
-			// stay put if already there
-			d += day - wday + 7*(day < wday);
-		}
-		else {
-			// could be more efficient!!!
-			maketime(y, m, 1, h, n, s);
-			localtime(&y, &m, &d, &h, &n, &s, &wday);
-			d = 1 + day - wday + 7*(day < wday);
-			ensure (1 <= d && d <= 7);
-			d = d + 7*(nth - 1);
-		}
-		maketime(y, m, d, h, n, s);
+		if (nth == 0)
+			d_ = weekday_on_or_after(d_, day); // stay put if already there
+		else
+			d_ = nth_weekday(year(), month(), nth, day);
 
 		return *this;
 	}
 	date& incr(int count, time_unit unit, const holiday_calendar& cal = CALENDAR_NONE)
 	{
-		int d0;
 		int one = count > 0 ? 1 : -1;
 
-		int y, m, d, h, n, s;
-		localtime(&y, &m, &d, &h, &n, &s);
-
 		switch (unit) {
 			case UNIT_SECONDS:
-				s += count;
-				maketime(y, m, d, h, n, s);
+				s_ += count;
+				normalize();
 				break;
 			case UNIT_MINUTES:
-				n += count;
-				maketime(y, m, d, h, n, s);
+				s_ += 60*count;
+				normalize();
 				break;
 			case UNIT_HOURS:
-				h += count;
-				maketime(y, m, d, h, n, s);
+				s_ += 3600*count;
+				normalize();
 				break;
 			case UNIT_DAYS:
-				d += count;
-				maketime(y, m, d, h, n, s);				
+				d_ += count;
 				break;
 			case UNIT_WEEKS:
-				d += 7*count;
-				maketime(y, m, d, h, n, s);
+				d_ += 7*count;
 				break;
 			case UNIT_MONTHS:
-				maketime(y, m + count, d, h, n, s);
-				localtime(&y, &m, &d0, &h, &n, &s);
-				if (d != d0) {
-					// went into next month
-					incr(0, UNIT_FIRST_OF_MONTH);
-					incr(-1, UNIT_DAY);
-				}
+				// end of month if the day is past the end of the month
+				d_ = add_months(d_, count);
 				break;
-			case UNIT_YEARS:
-				y += count;
-				maketime(y, m, d, h, n, s);
+			case UNIT_YEARS: {
+				// February 29 goes to March 1 like mktime
+				int y, m, d;
+				civil_from_days(d_, &y, &m, &d);
+				d_ = days_from_civil(y + count, m, 1) + d - 1;
 				break;
+			}
 			case UNIT_BUSINESS_DAYS:
+				if (const bitmap_calendar* b = cal.target<bitmap_calendar>()) {
+					d_ = b->offset(d_, count);
+
+					break;
+				}
 				if (count < 0) {
 					count = -count;
 				}
 				while (0 != count) {
-					d += one;
-					maketime(y, m, d, h, n, s);
+					d_ += one;
 					if (is_bday(cal)) {
 						count--;
 					}
 				}
 				break;
 			case UNIT_FIRST_OF_MONTH:
-				if (count)
-					incr(count, UNIT_MONTHS);
-				localtime(&y, &m, &d, &h, &n, &s);
-				maketime(y, m, 1, h, n, s);
+				d_ = first_of_month(d_, count);
 				break;
 			case UNIT_END_OF_MONTH:
-				incr(count + 1, UNIT_MONTHS);
-				incr(0, UNIT_FIRST_OF_MONTH);
-				incr(-1, UNIT_DAY);
+				d_ = end_of_month(d_, count);
 				break;
 			default:
 				ensure(!"date::incr: unknown unit");
@@ -659,6 +834,213 @@ public:
 	}
 }; // class date
 
+inline bitmap_calendar::bitmap_calendar(const holiday_calendar& cal, int y0, int y1, const std::string& name)
+{
+	ensure (y0 < y1);
+
+	std::shared_ptr<data> p(new data);
+
+	p->name = name;
+	p->y0 = y0;
+	p->y1 = y1;
+	uint64_t* h = allocate(*p, days_from_civil(y0, 1, 1), days_from_civil(y1, 1, 1) - days_from_civil(y0, 1, 1));
+	uint64_t* b = h + p->nw;
+	p->cal = cal;
+
+	for (int i = 0; i < p->n; ++i) {
+		date d(1970, 1, 1 + p->d0 + i);
+		uint64_t bit = uint64_t(1) << (i & 63);
+
+		if (cal(d))
+			h[i >> 6] |= bit;
+		else if (d.is_workday())
+			b[i >> 6] |= bit;
+	}
+
+	index(*p);
+
+	p_ = p;
+}
+
+inline void bitmap_calendar::index(data& p)
+{
+	p.rank.resize(p.nw + 1);
+	p.rank[0] = 0;
+	p.select.clear();
+	for (size_t w = 0; w < p.nw; ++w) {
+		p.rank[w + 1] = p.rank[w] + popcount(p.bday[w]);
+		for (int k = (p.rank[w] + 63) & ~63; k < p.rank[w + 1]; k += 64)
+			p.select.push_back(static_cast<int>(w));
+	}
+}
+
+inline bitmap_calendar bitmap_calendar::join(const std::vector<bitmap_calendar>& cals, calendar_join op)
+{
+	ensure (cals.size() > 0);
+	ensure (op == CALENDAR_UNION || op == CALENDAR_INTERSECTION);
+
+	// Cached by the operation and the component bitmaps, not their names, since
+	// calendars with the same name can have different holidays or years.
+	// The cache only holds joins that are in use. A live join keeps its components
+	// alive so the key pointers are valid, and expired entries are dropped on insert.
+	typedef std::pair<int, std::vector<const data*>> cache_key;
+	static std::mutex mutex;
+	static std::map<cache_key, std::weak_ptr<const data>> cache;
+
+	cache_key key(op, std::vector<const data*>());
+	std::vector<std::string> names;
+	bool named = true;
+	for (size_t i = 0; i < cals.size(); ++i) {
+		key.second.push_back(cals[i].p_.get());
+		names.push_back(cals[i].name());
+		named = named && !names.back().empty();
+	}
+	std::sort(key.second.begin(), key.second.end());
+	key.second.erase(std::unique(key.second.begin(), key.second.end()), key.second.end());
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+
+	// name is the sorted names separated by the operation, joins in parentheses
+	std::string name;
+	for (size_t i = 0; i < names.size(); ++i) {
+		bool nested = names[i].find_first_of("|&") != std::string::npos;
+		name += (i ? (op == CALENDAR_UNION ? "|" : "&") : "");
+		name += nested ? "(" + names[i] + ")" : names[i];
+	}
+
+	if (named) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto i = cache.find(key);
+		if (i != cache.end()) {
+			std::shared_ptr<const data> join = i->second.lock();
+			if (join)
+				return bitmap_calendar(join);
+		}
+	}
+
+	std::shared_ptr<data> p(new data);
+
+	p->name = named ? name : "";
+	p->y0 = cals[0].first_year();
+	p->y1 = cals[0].last_year();
+	for (size_t i = 1; i < cals.size(); ++i) {
+		p->y0 = std::max(p->y0, cals[i].first_year());
+		p->y1 = std::min(p->y1, cals[i].last_year());
+	}
+	ensure (p->y0 < p->y1);
+	uint64_t* h = allocate(*p, days_from_civil(p->y0, 1, 1), days_from_civil(p->y1, 1, 1) - days_from_civil(p->y0, 1, 1));
+	uint64_t* b = h + p->nw;
+	size_t nw = p->nw;
+	std::fill(h, h + nw, op == CALENDAR_UNION ? 0 : ~uint64_t(0));
+	std::fill(b, b + nw, op == CALENDAR_UNION ? ~uint64_t(0) : 0);
+	for (size_t i = 0; i < cals.size(); ++i) {
+		const data& c = *cals[i].p_;
+		size_t i0 = p->d0 - c.d0;
+
+		// holiday in any means business day in all
+		for (size_t w = 0; w < nw; ++w) {
+			if (op == CALENDAR_UNION) {
+				h[w] |= bits(c.holiday, c.nw, i0 + 64*w);
+				b[w] &= bits(c.bday, c.nw, i0 + 64*w);
+			}
+			else {
+				h[w] &= bits(c.holiday, c.nw, i0 + 64*w);
+				b[w] |= bits(c.bday, c.nw, i0 + 64*w);
+			}
+		}
+	}
+	if (p->n & 63) {
+		uint64_t mask = (uint64_t(1) << (p->n & 63)) - 1;
+
+		h[nw - 1] &= mask;
+		b[nw - 1] &= mask;
+	}
+
+	// outside of the common years
+	p->cal = [cals,op](const date& d) -> bool {
+		for (size_t i = 0; i < cals.size(); ++i) {
+			if (cals[i](d) == (op == CALENDAR_UNION))
+				return op == CALENDAR_UNION;
+		}
+
+		return op != CALENDAR_UNION;
+	};
+
+	index(*p);
+
+	if (named) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (auto i = cache.begin(); i != cache.end(); ) {
+			if (i->second.expired())
+				i = cache.erase(i);
+			else
+				++i;
+		}
+
+		// another thread may have joined the same calendars
+		std::weak_ptr<const data>& w = cache[key];
+		std::shared_ptr<const data> join = w.lock();
+		if (join)
+			return bitmap_calendar(join);
+		w = p;
+	}
+
+	return bitmap_calendar(std::shared_ptr<const data>(p));
+}
+
+inline int bitmap_calendar::count(int d0, int d1) const
+{
+	if (d1 < d0)
+		return -count(d1, d0);
+
+	if (in_range(d0) && d1 <= p_->d0 + p_->n)
+		return rank(d1 - p_->d0) - rank(d0 - p_->d0);
+
+	int n = 0;
+	for (int d = d0; d < d1; ++d)
+		n += is_bday(d);
+
+	return n;
+}
+
+inline int bitmap_calendar::offset(int d, int n) const
+{
+	if (in_range(d)) {
+		// index of the business day
+		int k = rank(d - p_->d0) + (n > 0 ? is_bday(d) + n - 1 : n);
+
+		if (n == 0)
+			return d;
+		if (0 <= k && k < p_->rank.back())
+			return p_->d0 + select(k);
+	}
+
+	for (int one = n > 0 ? 1 : -1; n; n -= one) {
+		do {
+			d += one;
+		} while (!is_bday(d));
+	}
+
+	return d;
+}
+
+inline bool bitmap_calendar::is_holiday(int d) const
+{
+	return in_range(d) ? test(p_->holiday, d - p_->d0) : p_->cal(date(1970, 1, 1 + d));
+}
+
+inline bool bitmap_calendar::is_bday(int d) const
+{
+	return in_range(d) ? test(p_->bday, d - p_->d0) : date(1970, 1, 1 + d).is_bday(p_->cal);
+}
+
+inline bool bitmap_calendar::operator()(const date& d) const
+{
+	return is_holiday(d.days());
+}
+
 	struct interval {
 		int count_; time_unit unit_; // e.g., 2, UNIT_WEEKS
 		day_count_basis dcb_;
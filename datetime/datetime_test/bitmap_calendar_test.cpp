@@ -0,0 +1,146 @@
+// bitmap_calendar_test.cpp - test precomputed holiday calendars
+#include "../../include/ensure.h"
+#include "../calendar.h"
+
+using namespace datetime;
+
+void datetime_bitmap_calendar_same_test(void)
+{
+	bitmap_calendar nys(calendar::NYS, 1990, 2030, "NYS");
+	holiday_calendar cal(nys);
+
+	ensure (nys.name() == "NYS");
+	ensure (nys.first_year() == 1990 && nys.last_year() == 2030);
+	ensure (cal.target<bitmap_calendar>());
+
+	// inside and outside of the range
+	for (date d(1985, 1, 1); d < date(2035, 1, 1); d.incr(1, UNIT_DAY)) {
+		ensure (nys(d) == calendar::NYS(d));
+		ensure (d.is_holiday(cal) == d.is_holiday(calendar::NYS));
+		ensure (d.is_bday(cal) == d.is_bday(calendar::NYS));
+	}
+
+	ensure (!date(2001, 9, 11).is_bday(cal));
+	ensure (date(2001, 9, 11).is_holiday(cal));
+	ensure (date(2001, 9, 17).is_bday(cal));
+}
+
+// long business day counts and offsets
+void datetime_bitmap_calendar_long_test(void)
+{
+	holiday_calendar cal(bitmap_calendar(calendar::NYB, 2000, 2060));
+	date d0(2010, 1, 1), d1(2050, 1, 1);
+
+	ensure (d0.diffworkdays(d1, cal) == d0.diffworkdays(d1, calendar::NYB));
+	ensure (date(d0).incr(1000, UNIT_BUSINESS_DAYS, cal) == date(d0).incr(1000, UNIT_BUSINESS_DAYS, calendar::NYB));
+}
+
+// rank and select against day by day loops
+void datetime_bitmap_calendar_rank_test(void)
+{
+	bitmap_calendar lnb(calendar::LnB, 2000, 2020);
+	holiday_calendar cal(lnb);
+
+	for (date d0(1999, 12, 1); d0 < date(2020, 2, 1); d0.incr(17, UNIT_DAYS)) {
+		for (int i = -400; i <= 400; i += 37) {
+			date d1 = date(d0).incr(i, UNIT_DAYS);
+
+			ensure (d0.diffworkdays(d1, cal) == d0.diffworkdays(d1, calendar::LnB));
+			ensure (lnb.count(d0.days(), d1.days()) == -lnb.count(d1.days(), d0.days()));
+			ensure (date(d0).incr(i, UNIT_BUSINESS_DAYS, cal) == date(d0).incr(i, UNIT_BUSINESS_DAYS, calendar::LnB));
+		}
+	}
+
+	// every business day in range
+	int d0 = days_from_civil(2000, 1, 1);
+	int n = lnb.count(d0, days_from_civil(2020, 1, 1));
+	for (int k = 1, d = d0 - 1; k <= n; ++k) {
+		do {
+			++d;
+		} while (!lnb.is_bday(d));
+		ensure (lnb.offset(d0 - 1, k) == d);
+		ensure (lnb.count(d0, d + 1) == k);
+	}
+}
+
+// joint calendars against composed predicates
+void datetime_bitmap_calendar_join_test(void)
+{
+	bitmap_calendar nyb(calendar::NYB, 2000, 2030, "NYB");
+	bitmap_calendar lnb(calendar::LnB, 1995, 2025, "LnB");
+
+	bitmap_calendar u = bitmap_calendar::join(nyb, lnb);
+	bitmap_calendar i = bitmap_calendar::join(lnb, nyb, CALENDAR_INTERSECTION);
+	ensure (u.name() == "LnB|NYB");
+	ensure (i.name() == "LnB&NYB");
+	ensure (u.first_year() == 2000 && u.last_year() == 2025);
+
+	holiday_calendar cu(u), ci(i);
+	for (date d(1990, 1, 1); d < date(2035, 1, 1); d.incr(1, UNIT_DAY)) {
+		bool h0 = calendar::NYB(d), h1 = calendar::LnB(d);
+
+		ensure (d.is_holiday(cu) == (h0 || h1));
+		ensure (d.is_holiday(ci) == (h0 && h1));
+		ensure (d.is_bday(cu) == (d.is_bday(calendar::NYB) && d.is_bday(calendar::LnB)));
+		ensure (d.is_bday(ci) == (d.is_bday(calendar::NYB) || d.is_bday(calendar::LnB)));
+	}
+	ensure (date(2000, 1, 1).diffworkdays(date(2024, 12, 31), cu)
+		== date(2000, 1, 1).diffworkdays(date(2024, 12, 31), [](const date& d) { return calendar::NYB(d) || calendar::LnB(d); }));
+
+	// cached joins share data
+	std::vector<bitmap_calendar> c;
+	c.push_back(lnb);
+	c.push_back(nyb);
+	c.push_back(nyb);
+	ensure (&bitmap_calendar::join(c).name() == &u.name());
+	ensure (&bitmap_calendar::join(c, CALENDAR_INTERSECTION).name() == &i.name());
+
+	// nested joins with different grouping
+	bitmap_calendar nys_(calendar::NYS, 2000, 2020, "NYS");
+	bitmap_calendar a = bitmap_calendar::join(bitmap_calendar::join(lnb, nyb), nys_, CALENDAR_INTERSECTION);
+	bitmap_calendar b = bitmap_calendar::join(lnb, bitmap_calendar::join(nyb, nys_, CALENDAR_INTERSECTION));
+	ensure (a.name() == "(LnB|NYB)&NYS");
+	ensure (b.name() == "LnB|(NYB&NYS)");
+	for (date d(2000, 1, 1); d < date(2020, 1, 1); d.incr(1, UNIT_DAY)) {
+		bool h0 = calendar::NYB(d), h1 = calendar::LnB(d), h2 = calendar::NYS(d);
+
+		ensure (a(d) == ((h1 || h0) && h2));
+		ensure (b(d) == (h1 || (h0 && h2)));
+	}
+
+	// same names with different years
+	bitmap_calendar nyb2(calendar::NYB, 2010, 2040, "NYB");
+	bitmap_calendar u2 = bitmap_calendar::join(nyb2, lnb);
+	ensure (u2.name() == "LnB|NYB");
+	ensure (u2.first_year() == 2010 && u2.last_year() == 2025);
+	ensure (bitmap_calendar::join(nyb, lnb).first_year() == 2000);
+
+	// same names with different holidays
+	bitmap_calendar nyb3([](const date& d) { return calendar::NYB(d) || d == date(2012, 10, 29); }, 2000, 2030, "NYB");
+	ensure (bitmap_calendar::join(nyb3, lnb)(date(2012, 10, 29)));
+	ensure (!bitmap_calendar::join(nyb, lnb)(date(2012, 10, 29)));
+
+	// unnamed calendars are not cached
+	bitmap_calendar nys(calendar::NYS, 2000, 2010);
+	ensure (bitmap_calendar::join(nys, nyb).name() == "");
+	ensure (&bitmap_calendar::join(nys, nyb).name() != &bitmap_calendar::join(nys, nyb).name());
+
+	// the cache does not keep joins or their components alive
+	std::weak_ptr<const void> wx, wxy;
+	{
+		bitmap_calendar x(calendar::NYB, 2000, 2010, "X"), y(calendar::LnB, 2000, 2010, "Y");
+		bitmap_calendar xy = bitmap_calendar::join(x, y);
+		wx = x.identity();
+		wxy = xy.identity();
+		ensure (bitmap_calendar::join(y, x).identity() == wxy.lock());
+	}
+	ensure (wx.expired() && wxy.expired());
+}
+
+void datetime_bitmap_calendar_test(void)
+{
+	datetime_bitmap_calendar_same_test();
+	datetime_bitmap_calendar_rank_test();
+	datetime_bitmap_calendar_join_test();
+	datetime_bitmap_calendar_long_test();
+}
@@ -0,0 +1,66 @@
+// calendar_file_test.cpp - test memory mapped calendar files
+#include <cstdio>
+#include "../../include/ensure.h"
+#include "../calendar_file.h"
+
+using namespace datetime;
+
+void datetime_calendar_file_test(void)
+{
+	const char* path = "calendar_file_test.cal";
+
+	std::vector<bitmap_calendar> cals;
+	cals.push_back(bitmap_calendar(calendar::NYB, 2000, 2030, "NYB"));
+	cals.push_back(bitmap_calendar(calendar::LnB, 1990, 2021, "LnB"));
+	// ad hoc closure
+	cals.push_back(bitmap_calendar([](const date& d) {
+		return calendar::NYS(d) || d == date(2012, 10, 29) || d == date(2012, 10, 30);
+	}, 2010, 2015, "NYS"));
+	calendar_file::write(path, cals);
+
+	{
+		calendar_file f(path);
+		ensure (f.size() == 3);
+		ensure (f[0].name() == "NYB" && f[1].name() == "LnB" && f[2].name() == "NYS");
+		ensure (f[1].first_year() == 1990 && f[1].last_year() == 2021);
+
+		for (date d(1985, 1, 1); d < date(2035, 1, 1); d.incr(1, UNIT_DAYS)) {
+			ensure (f[0](d) == calendar::NYB(d));
+			ensure (f[1](d) == calendar::LnB(d));
+			ensure (f[2](d) == cals[2](d) || d.year() < 2010 || d.year() >= 2015);
+			// outside of the file years use calendar.h
+			ensure (f[2](d) == calendar::NYS(d) || (d.year() == 2012 && d.month() == 10));
+		}
+		ensure (f[2](date(2012, 10, 29)));
+
+		date d0(2001, 3, 4), d1(2028, 11, 20);
+		ensure (d0.diffworkdays(d1, f[0]) == d0.diffworkdays(d1, cals[0]));
+		ensure (date(d0).incr(777, UNIT_BUSINESS_DAYS, f[0]) == date(d0).incr(777, UNIT_BUSINESS_DAYS, cals[0]));
+
+		// rewriting the file leaves existing mappings alone
+		std::vector<bitmap_calendar> gbp(1, bitmap_calendar(calendar::GBP, 2000, 2001, "GBP"));
+		calendar_file::write(path, gbp);
+		ensure (f.size() == 3 && f[0].name() == "NYB");
+		for (date d(2000, 1, 1); d < date(2030, 1, 1); d.incr(1, UNIT_DAYS))
+			ensure (f[0](d) == calendar::NYB(d));
+
+		calendar_file g(path);
+		ensure (g.size() == 1 && g[0].name() == "GBP");
+		calendar_file::write(path, cals);
+	}
+
+	ensure (load_calendars(path) == 3);
+	// the mapping outlives the file
+	std::remove(path);
+
+	ensure (has_calendar("NYB") && has_calendar("LnB") && has_calendar("NYS"));
+	ensure (!has_calendar("XXX"));
+	holiday_calendar nyb = find_calendar("NYB");
+	ensure (nyb.target<bitmap_calendar>());
+	ensure (date(2012, 1, 16).is_holiday(nyb));
+	ensure (!date(2012, 1, 17).is_holiday(nyb));
+	ensure (find_calendar("NYS")(date(2012, 10, 30)));
+
+	register_calendar(cals[0]);
+	ensure (&find_calendar("NYB").name() == &cals[0].name());
+}
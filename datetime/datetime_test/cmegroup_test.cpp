@@ -0,0 +1,110 @@
+// cmegroup_test.cpp - test CME contract symbols
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../../include/ensure.h"
+#include "../cmegroup.h"
+
+using namespace cmegroup;
+
+void datetime_cmegroup_code_test(void)
+{
+	ensure (futures_month_code(12) == 'Z');
+	ensure (futures_code_month('z') == 12);
+	ensure (futures_code_month('A') == 0);
+	ensure (option_month_code(-3) == 'O');
+	ensure (option_code_month('c') == 3);
+}
+
+void datetime_futures_symbol_test(void)
+{
+	futures_symbol s;
+	char buf[8];
+
+	ensure (futures_parse("EDZ4", "EDZ4" + 4, s, 2010));
+	ensure (0 == strcmp(s.root, "ED") && s.month == 12 && s.year == 2014);
+	ensure (s.expiry == datetime::days_from_civil(2014, 12, 17));
+	ensure (futures_format(s, buf) == 4 && 0 == memcmp(buf, "EDZ4", 4));
+	ensure (futures_format(s, buf, 2) == 5 && 0 == memcmp(buf, "EDZ14", 5));
+
+	ensure (futures_parse("GEH25", "GEH25" + 5, s, 2020));
+	ensure (0 == strcmp(s.root, "GE") && s.month == 3 && s.year == 2025);
+	ensure (s.expiry == datetime::days_from_civil(2025, 3, 19));
+
+	// one digit years are on or after the base year
+	ensure (futures_parse("EDH3", "EDH3" + 4, s, 2014) && s.year == 2023);
+	ensure (futures_parse("EDH4", "EDH4" + 4, s, 2014) && s.year == 2014);
+	ensure (futures_parse("EDH05", "EDH05" + 5, s, 1999) && s.year == 2005);
+	ensure (futures_parse("EDH98", "EDH98" + 5, s, 1999) && s.year == 2098);
+
+	// roots with digits and one character
+	ensure (futures_parse("6EM4", "6EM4" + 4, s, 2010) && 0 == strcmp(s.root, "6E") && s.month == 6);
+	ensure (futures_parse("CZ9", "CZ9" + 3, s, 2010) && 0 == strcmp(s.root, "C") && s.month == 12);
+	ensure (futures_parse("NKDU7", "NKDU7" + 5, s, 2010) && 0 == strcmp(s.root, "NKD"));
+
+	ensure (!futures_parse("EDA4", "EDA4" + 4, s, 2010) && s.month == 0);
+	ensure (!futures_parse("Z4", "Z4" + 2, s, 2010));
+	ensure (!futures_parse("EDZ", "EDZ" + 3, s, 2010));
+	ensure (!futures_parse("ED-Z4", "ED-Z4" + 5, s, 2010));
+	ensure (!futures_parse("ABCDZ4", "ABCDZ4" + 6, s, 2010));
+	ensure (!futures_parse("EDZ144", "EDZ144" + 6, s, 2010));
+}
+
+// symbols in a contiguous buffer
+void datetime_futures_batch_test(size_t n = 200000)
+{
+	static const char* roots[] = { "ED", "GE", "ES", "CL", "ZN", "6E", "NKD", "C" };
+	std::string buf;
+	char sym[8];
+
+	for (size_t i = 0; i < n; ++i) {
+		futures_symbol s;
+		strcpy(s.root, roots[i%8]);
+		s.month = 1 + static_cast<int>(i%12);
+		s.year = 2010 + static_cast<int>(i%10);
+		buf.append(sym, futures_format(s, sym, 1 + i%2));
+		buf += i%3 ? "\n" : "\r\n";
+	}
+	buf += "\nbad\n";
+
+	std::vector<futures_symbol> s(n + 2);
+	size_t m = futures_parse(buf.data(), buf.size(), &s[0], s.size(), 2010);
+
+	ensure (m == n + 1);
+	ensure (s[n].month == 0);
+	for (size_t i = 0; i < n; ++i) {
+		ensure (0 == strcmp(s[i].root, roots[i%8]));
+		ensure (s[i].month == 1 + static_cast<int>(i%12));
+		ensure (s[i].year == 2010 + static_cast<int>(i%10));
+		ensure (s[i].expiry == datetime::imm_date(s[i].year, s[i].month));
+	}
+
+	// stops at n
+	ensure (futures_parse(buf.data(), buf.size(), &s[0], 10, 2010) == 10);
+
+	// one string per symbol
+	std::istringstream is(buf);
+	std::string line;
+	size_t m0 = 0;
+	while (std::getline(is, line)) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty())
+			continue;
+
+		futures_symbol s0;
+		futures_parse(line.data(), line.data() + line.size(), s0, 2010);
+		ensure (0 == strcmp(s0.root, s[m0].root));
+		ensure (s0.month == s[m0].month && s0.year == s[m0].year);
+		++m0;
+	}
+	ensure (m0 == m);
+}
+
+void datetime_cmegroup_test(void)
+{
+	datetime_cmegroup_code_test();
+	datetime_futures_symbol_test();
+	datetime_futures_batch_test();
+}
@@ -0,0 +1,263 @@
+// date_test.cpp - test date class
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include "../../include/ensure.h"
+#include "../datetime.h"
+#include "../day.h"
+
+using namespace datetime;
+
+// pure civil algorithms round trip
+void datetime_civil_test(void)
+{
+	ensure (days_from_civil(1970, 1, 1) == 0);
+	ensure (days_from_civil(2000, 3, 1) == 11017);
+	ensure (days_from_civil(1969, 12, 31) == -1);
+	ensure (weekday_from_days(0) == DAY_THU);
+	ensure (weekday_from_days(-1) == DAY_WED);
+
+	int y0, m0, d0;
+	civil_from_days(-800000, &y0, &m0, &d0);
+	int z = days_from_civil(y0, m0, d0);
+	ensure (z == -800000);
+	for (; z < 800000; ++z) {
+		int y, m, d;
+
+		civil_from_days(z, &y, &m, &d);
+		ensure (days_from_civil(y, m, d) == z);
+		ensure (1 <= d && d <= days_in_month(y, m));
+		if (d == 1)
+			ensure (m == m0%12 + 1 && (m != 1 || y == y0 + 1));
+		ensure (weekday_from_days(z) == (weekday_from_days(z - 1) + 1)%7);
+		y0 = y; m0 = m; d0 = d;
+	}
+}
+
+// agrees with the C library
+void datetime_date_libc_test(void)
+{
+	for (time_t t = 0; t < 0x7FFFFFFF - 86400*40; t += 86400*37 + 3607) {
+		struct tm tm = *::localtime(&t);
+		date d(t);
+
+		ensure (d.year() == tm.tm_year + 1900);
+		ensure (d.month() == tm.tm_mon + 1);
+		ensure (d.day() == tm.tm_mday);
+		ensure (d.hour() == tm.tm_hour);
+		ensure (d.minute() == tm.tm_min);
+		ensure (d.second() == tm.tm_sec);
+		ensure (d.weekday() == tm.tm_wday);
+		ensure (d.yearday() == tm.tm_yday);
+		ensure (d.is_dst() == tm.tm_isdst);
+		ensure (d.time() == t);
+		ensure (date(d.excel()) == d);
+	}
+}
+
+void datetime_date_incr_test(void)
+{
+	date d(2012, 1, 31);
+
+	ensure (date(d).incr(1, UNIT_MONTH) == date(2012, 2, 29));
+	ensure (date(d).incr(13, UNIT_MONTHS) == date(2013, 2, 28));
+	ensure (date(d).incr(-2, UNIT_MONTHS) == date(2011, 11, 30));
+	ensure (date(d).incr(1, UNIT_DAY) == date(2012, 2, 1));
+	ensure (date(d).incr(25, UNIT_HOURS) == date(2012, 2, 1, 1));
+	ensure (date(d).incr(0, UNIT_END_OF_MONTH) == d);
+	ensure (date(2012, 2, 3).incr(0, UNIT_FIRST_OF_MONTH) == date(2012, 2, 1));
+	ensure (date(2012, 14, 1) == date(2013, 2, 1));
+	ensure (date(2012, 3, 0) == date(2012, 2, 29));
+	ensure (date(2012, 1, 1, -1) == date(2011, 12, 31, 23));
+
+	ensure (date(2012, 3, 1).diffdays(date(2012, 2, 1)) == 29);
+	ensure (date(2012, 2, 1).diffdays(date(2012, 3, 1)) == -29);
+	ensure (date(2013, 1, 1).is_leap() == 0);
+	ensure (date(2012, 1, 1).ymd() == 20120101);
+	ensure (date(2012, 1, 1, 13, 14, 15).hms() == 131415);
+	ensure (date(2012, 2, 29).excel() == 40968);
+	ensure (fabs(time_t2excel(excel2time_t(40968.5)) - 40968.5) < 1/SECS_PER_DAY);
+	ensure (fabs(time_t2excel(excel2time_t(40968.5, true), true) - 40968.5) < 1/SECS_PER_DAY);
+
+	// third Wednesday
+	ensure (date(2012, 3, 1).imm(3, DAY_WED) == date(2012, 3, 21));
+	// modified following
+	ensure (date(2012, 3, 31).adjust(ROLL_MODIFIED_FOLLOWING) == date(2012, 3, 30));
+}
+
+// accessors do not use shared C library state
+void datetime_date_thread_test(void)
+{
+	std::vector<std::thread> t;
+	std::vector<int> ok(4, 0);
+
+	for (size_t i = 0; i < ok.size(); ++i) {
+		t.push_back(std::thread([i,&ok]() {
+			date d(2000 + static_cast<int>(i), 1, 31);
+			int n = 0;
+
+			for (int j = 0; j < 120; ++j) {
+				date dj = date(d).incr(j, UNIT_MONTHS);
+				n += dj.month() == (j%12) + 1 && dj.year() == 2000 + static_cast<int>(i) + j/12;
+			}
+
+			ok[i] = n == 120;
+		}));
+	}
+	for (size_t i = 0; i < t.size(); ++i)
+		t[i].join();
+
+	for (size_t i = 0; i < ok.size(); ++i)
+		ensure (ok[i]);
+}
+
+// n-th day of week by breaking out and rebuilding dates
+inline date imm_iterative(date t, int nth, day_of_week day)
+{
+	int y, m, d, h, n, s;
+
+	t.localtime(&y, &m, &d, &h, &n, &s);
+	int wday = t.weekday();
+	if (nth == 0) {
+		d += day - wday + 7*(day < wday);
+	}
+	else {
+		wday = date(y, m, 1).weekday();
+		d = 1 + day - wday + 7*(day < wday) + 7*(nth - 1);
+	}
+
+	return date(y, m, d, h, n, s);
+}
+
+void datetime_date_imm_test(void)
+{
+	static_assert (imm_date(2012, 3) == days_from_civil(2012, 3, 21), "imm date");
+
+	for (date t(1999, 12, 1, 9, 30, 0); t < date(2004, 1, 1); t.incr(1, UNIT_DAYS)) {
+		for (int nth = 0; nth <= 5; ++nth) {
+			for (int w = DAY_SUN; w < DAY_MAX; ++w) {
+				day_of_week day = static_cast<day_of_week>(w);
+				ensure (date(t).imm(nth, day) == imm_iterative(t, nth, day));
+			}
+		}
+	}
+
+	// next IMM dates on or after
+	int imm[8];
+	imm_dates(days_from_civil(2012, 3, 21), 8, imm);
+	ensure (imm[0] == days_from_civil(2012, 3, 21));
+	ensure (imm[1] == days_from_civil(2012, 6, 20));
+	ensure (imm[7] == days_from_civil(2013, 12, 18));
+	imm_dates(days_from_civil(2012, 3, 22), 1, imm);
+	ensure (imm[0] == days_from_civil(2012, 6, 20));
+	imm_dates(days_from_civil(2012, 12, 31), 1, imm);
+	ensure (imm[0] == days_from_civil(2013, 3, 20));
+
+	day serial[3];
+	imm_dates(day(2012, 4, 1), 3, serial, 1);
+	ensure (serial[0] == day(2012, 4, 18) && serial[1] == day(2012, 5, 16) && serial[2] == day(2012, 6, 20));
+
+	for (int z = day(1995, 1, 1).serial(); z < day(2005, 1, 1).serial(); ++z) {
+		imm_dates(z, 2, imm);
+		ensure (z <= imm[0] && imm[0] < imm[1]);
+		date t(1970, 1, 1 + imm[0]);
+		ensure (t.month()%3 == 0 && t == date(t).imm(3, DAY_WED));
+		ensure (date(t).incr(-3, UNIT_MONTHS).imm(3, DAY_WED).days() < z);
+		ensure (date(1970, 1, 1 + imm[1]) == date(t).incr(3, UNIT_MONTHS).imm(3, DAY_WED));
+	}
+}
+
+// strips of quarterly futures
+void datetime_date_imm_strip_test(size_t n = 10000, size_t m = 40)
+{
+	std::vector<int> s0(m), s(m);
+	int z0 = days_from_civil(2000, 1, 1);
+
+	for (size_t i = 0; i < n; ++i) {
+		date d(1970, 1, 1 + z0 + static_cast<int>(i));
+		date d0 = date(d.year(), d.month() + (3 - d.month()%3)%3, 1).imm(3, DAY_WED);
+		if (d0 < d)
+			d0 = date(d.year(), d.month() + (3 - d.month()%3)%3 + 3, 1).imm(3, DAY_WED);
+		for (size_t j = 0; j < m; ++j)
+			s0[j] = date(d0).incr(3*static_cast<int>(j), UNIT_MONTHS).imm(3, DAY_WED).days();
+
+		imm_dates(z0 + static_cast<int>(i), m, &s[0]);
+		ensure (s0 == s);
+	}
+}
+
+// month increments with the C library the way date used to do them
+inline date incr_months_libc(const date& d, int count, time_unit unit)
+{
+	struct tm tm;
+	time_t t = d.time();
+	datetime::localtime(t, &tm);
+	int mday = tm.tm_mday;
+
+	if (unit == UNIT_END_OF_MONTH) {
+		tm.tm_mon += count + 1;
+		tm.tm_mday = 0;
+	}
+	else if (unit == UNIT_FIRST_OF_MONTH) {
+		tm.tm_mon += count;
+		tm.tm_mday = 1;
+	}
+	else {
+		tm.tm_mon += count;
+	}
+	tm.tm_isdst = -1;
+	t = mktime(&tm);
+	datetime::localtime(t, &tm);
+	if (unit == UNIT_MONTHS && tm.tm_mday != mday) {
+		// went into next month
+		tm.tm_mday = 0;
+		tm.tm_isdst = -1;
+		t = mktime(&tm);
+		datetime::localtime(t, &tm);
+	}
+
+	return date(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+}
+
+void datetime_date_month_test(void)
+{
+	static_assert (add_months(days_from_civil(2012, 1, 31), 1) == days_from_civil(2012, 2, 29), "add months");
+	static_assert (add_months(days_from_civil(2012, 3, 31), -13) == days_from_civil(2011, 2, 28), "add months");
+	static_assert (end_of_month(days_from_civil(1900, 2, 3)) == days_from_civil(1900, 2, 28), "end of month");
+	static_assert (first_of_month(days_from_civil(1969, 12, 3), 1) == 0, "first of month");
+
+	for (date d(2011, 12, 1, 10, 15, 0); d < date(2013, 3, 1); d.incr(1, UNIT_DAYS)) {
+		for (int n = -25; n <= 25; ++n) {
+			ensure (date(d).incr(n, UNIT_MONTHS) == incr_months_libc(d, n, UNIT_MONTHS));
+			ensure (date(d).incr(n, UNIT_END_OF_MONTH) == incr_months_libc(d, n, UNIT_END_OF_MONTH));
+			ensure (date(d).incr(n, UNIT_FIRST_OF_MONTH) == incr_months_libc(d, n, UNIT_FIRST_OF_MONTH));
+		}
+	}
+	ensure (date(2012, 2, 29).incr(1, UNIT_YEARS) == date(2013, 3, 1));
+	ensure (date(2012, 2, 29).incr(-4, UNIT_YEARS) == date(2008, 2, 29));
+	ensure (date(2012, 1, 1, 23, 59, 59).incr(1, UNIT_SECONDS) == date(2012, 1, 2));
+	ensure (date(2012, 1, 1).incr(-90, UNIT_MINUTES) == date(2011, 12, 31, 22, 30));
+}
+
+// monthly schedules, 30 years from each day
+void datetime_date_month_schedule_test(size_t n = 1000, int m = 360)
+{
+	for (size_t i = 0; i < n; ++i) {
+		date d(2000, 1, 1 + static_cast<int>(i), 12);
+		for (int j = 0; j < m; ++j)
+			ensure (date(d).incr(j, UNIT_MONTHS) == incr_months_libc(d, j, UNIT_MONTHS));
+	}
+}
+
+void datetime_date_test(void)
+{
+	datetime_civil_test();
+	datetime_date_libc_test();
+	datetime_date_incr_test();
+	datetime_date_thread_test();
+	datetime_date_imm_test();
+	datetime_date_imm_strip_test();
+	datetime_date_month_test();
+	datetime_date_month_schedule_test();
+}
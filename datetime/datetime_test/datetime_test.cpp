@@ -0,0 +1,33 @@
+// datetime_test.cpp - test date and time routines
+#include <iostream>
+
+void datetime_bitmap_calendar_test(void);
+void datetime_calendar_file_test(void);
+void datetime_cmegroup_test(void);
+void datetime_date_test(void);
+void datetime_day_count_test(void);
+void datetime_day_test(void);
+void datetime_holiday_test(void);
+void datetime_schedule_test(void);
+
+int
+main()
+{
+	try {
+		datetime_bitmap_calendar_test();
+		datetime_calendar_file_test();
+		datetime_cmegroup_test();
+		datetime_date_test();
+		datetime_day_count_test();
+		datetime_day_test();
+		datetime_holiday_test();
+		datetime_schedule_test();
+	}
+	catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+
+		return -1;
+	}
+
+	return 0;
+}
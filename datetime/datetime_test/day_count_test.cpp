@@ -0,0 +1,68 @@
+// day_count_test.cpp - test day count fractions on serial days
+#include <cmath>
+#include <vector>
+#include "../../include/ensure.h"
+#include "../day_count.h"
+
+using namespace datetime;
+
+void datetime_year_fraction_test(void)
+{
+	for (int z0 = 14000; z0 < 16000; z0 += 13) {
+		for (int dz = 1; dz < 366; dz += 29) {
+			day d0(z0), d1(z0 + dz);
+			date t0 = d0.to_date(), t1 = d1.to_date();
+
+			for (int b = DCB_30U_360; b < DCB_MAX; ++b) {
+				day_count_basis dcb = static_cast<day_count_basis>(b);
+				ensure (fabs(year_fraction(d0, d1, dcb) - t1.diff_dcb(t0, dcb)) < 1e-12);
+			}
+		}
+	}
+
+	ensure (year_fraction(day(2011, 7, 1), day(2014, 7, 1), DCB_ACTUAL_ACTUAL_ISDA) == 3);
+	ensure (fabs(year_fraction(day(2012, 1, 31), day(2012, 2, 29), DCB_30U_360) - 29/360.) < 1e-15);
+	ensure (fabs(year_fraction(day(2012, 1, 31), day(2012, 3, 31), DCB_30E_360) - 2/12.) < 1e-15);
+	ensure (year_fraction(day(2012, 1, 1), day(2012, 1, 2), DCB_MAX) != year_fraction(day(2012, 1, 1), day(2012, 1, 2), DCB_MAX));
+}
+
+// batch kernels against date::diff_dcb
+void datetime_year_fraction_batch_test(size_t n = 20000)
+{
+	std::vector<int32_t> d0(n), d1(n);
+	std::vector<date> t0(n), t1(n);
+	std::vector<double> t(n), u(n);
+
+	// ends of months and years, leap days and negative periods
+	for (size_t i = 0; i < n; ++i) {
+		d0[i] = -25000 + static_cast<int32_t>((i*7919)%90000);
+		d1[i] = d0[i] + static_cast<int32_t>((i*104729)%3000) - 500;
+		t0[i] = day(d0[i]).to_date();
+		t1[i] = day(d1[i]).to_date();
+	}
+
+	for (int b = 0; b <= DCB_MAX; ++b) {
+		day_count_basis dcb = static_cast<day_count_basis>(b);
+
+		for (size_t i = 0; i < n; ++i)
+			u[i] = t1[i].diff_dcb(t0[i], dcb);
+		year_fraction(n, &d0[0], &d1[0], dcb, &t[0]);
+
+		for (size_t i = 0; i < n; ++i) {
+			ensure (t[i] == year_fraction(d0[i], d1[i], dcb) || (t[i] != t[i] && dcb == DCB_MAX));
+			// date only agrees with ISDA for increasing dates in adjacent years
+			if (dcb == DCB_ACTUAL_ACTUAL_ISDA || dcb == DCB_ACTUAL_ACTUAL_ICMA) {
+				ensure (fabs(t[i] + year_fraction(d1[i], d0[i], dcb)) < 1e-14);
+				if (d1[i] < d0[i] || t1[i].year() - t0[i].year() > 1)
+					continue;
+			}
+			ensure (fabs(t[i] - u[i]) < 1e-12 || (u[i] != u[i] && t[i] != t[i]));
+		}
+	}
+}
+
+void datetime_day_count_test(void)
+{
+	datetime_year_fraction_test();
+	datetime_year_fraction_batch_test();
+}
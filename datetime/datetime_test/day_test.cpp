@@ -0,0 +1,64 @@
+// day_test.cpp - test serial days
+#include <type_traits>
+#include "../../include/ensure.h"
+#include "../day.h"
+
+using namespace datetime;
+
+static_assert (std::is_trivially_copyable<day>::value, "day must be trivially copyable");
+static_assert (sizeof(day) == 4, "day must be 32 bits");
+static_assert (day(1970, 1, 1).serial() == 0, "epoch");
+static_assert (day(2012, 2, 29).ymd() == 20120229, "ymd");
+static_assert (day(2012, 1, 31).add_months(1) == day(2012, 2, 29), "end of month");
+static_assert (day(2012, 3, 1) - day(2012, 2, 1) == 29, "day count");
+static_assert (day(2012, 13, 1) == day(2013, 1, 1), "normalize");
+
+void datetime_day_date_test(void)
+{
+	for (int z = -100000; z < 100000; z += 7) {
+		day d(z);
+		date t = d.to_date();
+
+		ensure (t.year() == d.year());
+		ensure (t.month() == d.month());
+		ensure (t.day() == d.mday());
+		ensure (t.weekday() == d.weekday());
+		ensure (day(t) == d);
+		ensure (date_convert<day>::encode(t) == d);
+		ensure (date_convert<day>::decode(d) == t);
+		ensure (day(d.excel()) == d || z < -25569);
+		ensure (t.excel() == d.excel());
+	}
+
+	for (int n = -30; n <= 30; ++n) {
+		for (int m = 1; m <= 12; ++m) {
+			for (int dd = 1; dd <= days_in_month(2011, m); dd += 3) {
+				day d(2011, m, dd);
+				date t = d.to_date();
+
+				ensure (d.add_months(n) == day(t.incr(n, UNIT_MONTHS)));
+			}
+		}
+	}
+
+	ensure (!day().is_valid());
+	ensure (day(0).is_valid());
+	ensure (day(2012, 2, 29).add_years(1) == day(2013, 2, 28));
+	ensure (day(2012, 2, 29).days_in_month() == 29);
+}
+
+// add_months agrees with date::incr
+void datetime_day_add_months_test(void)
+{
+	date d0(2000, 1, 31);
+	day d(2000, 1, 31);
+
+	for (int i = 0; i < 240; ++i)
+		ensure (d.add_months(i) == day(date(d0).incr(i, UNIT_MONTHS).days()));
+}
+
+void datetime_day_test(void)
+{
+	datetime_day_date_test();
+	datetime_day_add_months_test();
+}
@@ -0,0 +1,269 @@
+// holiday_test.cpp - test holiday rules and tables
+#include "../../include/ensure.h"
+#include "../calendar.h"
+
+using namespace datetime;
+
+static_assert (holiday::serial::easter(2012) == days_from_civil(2012, 4, 8), "easter");
+static_assert (holiday::serial::easter(2011) == days_from_civil(2011, 4, 24), "easter");
+static_assert (holiday::serial::thanksgiving_day(2012) == days_from_civil(2012, 11, 22), "thanksgiving");
+static_assert (holiday::table<holiday::serial::memorial_day>::value[2012 - holiday::YEAR_MIN] == days_from_civil(2012, 5, 28), "table");
+static_assert (holiday::table<holiday::serial::good_friday>::value[holiday::YEAR_MAX - 1 - holiday::YEAR_MIN] == holiday::serial::good_friday(2200), "table");
+
+// date based rules the tables replace
+namespace reference {
+	// http://www.assa.org.au/edm.html#Computer
+	inline
+	void easter_month_day(int y, int& m, int& d)
+	{
+		int fd, r, t;    // intermediate results
+		int tA, tB, tC, tD, tE;          // table A to E results
+
+		   fd = y / 100;              // first 2 digits of year
+		   r = y % 19;             // remainder of year / 19
+
+		//  calculate PFM date
+		   t = (fd - 15) / 2 + 202 - 11 * r;
+    
+		   switch (fd) {
+			  case 21: case 24: case 25: case 27: case 28: case 29: case 30: case 31: case 32: case 34: case 35: case 38:
+				 t = t - 1;
+
+				  break;
+			  case 33: case 36: case 37: case 39: case 40:
+				 t = t - 2;
+
+				 break;
+		   }
+		   t = t % 30;
+
+		   tA = t + 21;
+		   if (t == 29) tA = tA - 1;
+		   if (t == 28 && r > 10) tA = tA - 1;
+
+		// find the next Sunday
+		   tB = (tA - 19) % 7;
+    
+		   tC = (40 - fd) % 4;
+		   if (tC == 3) tC = tC + 1;
+		   if (tC > 1) tC = tC + 1;
+        
+		   t = y % 100;
+		   tD = (t + t / 4) % 7;
+    
+		   tE = ((20 - tB - tC - tD) % 7) + 1;
+		   d = tA + tE;
+
+		// return the date
+		   if (d > 31) {
+			  d = d - 31;
+			  m = 4;
+		   }
+		   else {
+			  m = 3;
+		   }
+
+		   ensure (DAY_SUN == date(y,m,d).weekday());
+	}
+
+	// standard holidays
+	inline date 
+	new_years_day(int year)
+	{
+		return date(year, MONTH_JAN, 1).adjust(ROLL_FOLLOWING_BUSINESS);
+	}
+	inline date 
+	martin_luther_kings_birthday(int year)
+	{
+		return date(year, MONTH_JAN, 1).imm(3, DAY_MON);
+	}
+	inline date 
+	presidents_day(int year)
+	{
+		return date(year, MONTH_FEB, 1).imm(3, DAY_MON);
+	}
+	inline date
+	st_patricks_day(int year)
+	{
+		return date(year, MONTH_MAR, 17);
+	}
+	inline date 
+	good_friday(int y)
+	{
+		int m, d;
+
+		easter_month_day(y, m, d);
+
+		return date(y, m, d - 2);
+	}
+	inline date 
+	easter(int y)
+	{
+		int m, d;
+
+		easter_month_day(y, m, d);
+
+		return date(y, m, d);
+	}
+	inline date 
+	easter_monday(int y)
+	{
+		int m, d;
+
+		easter_month_day(y, m, d);
+
+		return date(y, m, d + 1);
+	}
+	inline date 
+	may_day(int year)
+	{
+		date d(year, MONTH_MAY, 1);
+		int wday = d.weekday();
+
+		return wday == DAY_SAT ? d.incr(2, UNIT_DAY) : wday == DAY_SUN ? d.incr(1, UNIT_DAY) : d;
+	}
+	inline date 
+	may_day_bank_holiday(int year)
+	{
+		return date(year, MONTH_MAY, 1).imm(1, DAY_MON);
+	}
+	// last Monday in May
+	inline date 
+	memorial_day(int year)
+	{
+		return date(year, MONTH_MAY, 25).imm(0, DAY_MON);
+	}
+	inline date 
+	spring_bank_holiday(int year)
+	{
+		return date(year, MONTH_MAY, 25).imm(0, DAY_MON);
+	}
+	inline date 
+	june_bank_holiday(int year)
+	{
+		return date(year, MONTH_JUN, 1).imm(1, DAY_MON);
+	}
+	inline date 
+	independence_day(int year)
+	{
+		date d(year, MONTH_JUL, 4);
+		int wday = d.weekday();
+
+		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+	}
+	inline date 
+	summer_bank_holiday(int year)
+	{
+		return date(year, MONTH_AUG, 25).imm(0, DAY_MON); //???
+	}
+	inline date 
+	labor_day(int year)
+	{
+		return date(year, MONTH_SEP, 1).imm(1, DAY_MON);
+	}
+	inline date 
+	columbus_day(int year)
+	{
+		return date(year, MONTH_OCT, 1).imm(2, DAY_MON);
+	}
+	inline date 
+	veterans_day(int year)
+	{
+		date d(year, MONTH_NOV, 11);
+		int wday = d.weekday();
+
+		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+	}
+	inline date 
+	thanksgiving_day(int year)
+	{
+		return date(year, MONTH_NOV, 1).imm(4, DAY_THU);
+	}
+	inline date 
+	christmas_day(int year)
+	{
+		date d(year, MONTH_DEC, 25);
+		int wday = d.weekday();
+
+		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+	}
+	inline date 
+	boxing_day(int year)
+	{
+		date d(year, MONTH_DEC, 26);
+		int wday = d.weekday();
+
+		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+	}
+
+} // namespace reference
+
+#define HOLIDAY_TEST(h) ensure (holiday::h(y) == reference::h(y)); ensure (date(1970, 1, 1 + holiday::serial::h(y)) == reference::h(y));
+
+void datetime_holiday_rule_test(void)
+{
+	for (int y = 1900; y < 2400; ++y) {
+		int m, d, m0, d0;
+
+		holiday::easter_month_day(y, m, d);
+		reference::easter_month_day(y, m0, d0);
+		ensure (m == m0 && d == d0);
+
+		HOLIDAY_TEST(new_years_day)
+		HOLIDAY_TEST(martin_luther_kings_birthday)
+		HOLIDAY_TEST(presidents_day)
+		HOLIDAY_TEST(st_patricks_day)
+		HOLIDAY_TEST(good_friday)
+		HOLIDAY_TEST(easter)
+		HOLIDAY_TEST(easter_monday)
+		HOLIDAY_TEST(may_day)
+		HOLIDAY_TEST(may_day_bank_holiday)
+		HOLIDAY_TEST(memorial_day)
+		HOLIDAY_TEST(spring_bank_holiday)
+		HOLIDAY_TEST(june_bank_holiday)
+		HOLIDAY_TEST(independence_day)
+		HOLIDAY_TEST(summer_bank_holiday)
+		HOLIDAY_TEST(labor_day)
+		HOLIDAY_TEST(columbus_day)
+		HOLIDAY_TEST(veterans_day)
+		HOLIDAY_TEST(thanksgiving_day)
+		HOLIDAY_TEST(christmas_day)
+		HOLIDAY_TEST(boxing_day)
+	}
+}
+
+#undef HOLIDAY_TEST
+
+// calendar lookups against the date based rules
+void datetime_holiday_calendar_test(void)
+{
+	for (date d(2000, 1, 1); d < date(2040, 1, 1); d.incr(1, UNIT_DAYS)) {
+		int y = d.year();
+		date d0(y, d.month(), d.day());
+
+		bool h = d0 == reference::new_years_day(y)
+			|| (y == 2007 && d0 == date(2007, MONTH_JAN, 2))
+			|| (y >= 1998 && d0 == reference::martin_luther_kings_birthday(y))
+			|| d0 == reference::presidents_day(y)
+			|| d0 == reference::good_friday(y)
+			|| d0 == reference::memorial_day(y)
+			|| (y == 2004 && d0 == date(2004, MONTH_JUN, 11))
+			|| d0 == reference::independence_day(y)
+			|| d0 == reference::labor_day(y)
+			|| (y == 2001 && MONTH_SEP == d0.month() && 11 <= d0.day() && d0.day() <= 14)
+			|| d0 == reference::thanksgiving_day(y)
+			|| d0 == reference::christmas_day(y);
+		ensure (calendar::NYS(d) == h);
+	}
+
+	ensure (calendar::NYS(date(2001, 9, 12)));
+	ensure (calendar::NYS(date(2012, 4, 6, 13, 30, 0)));
+	ensure (!calendar::NYS(date(2012, 4, 9)));
+	ensure (calendar::LnB(date(2012, 4, 9)));
+}
+
+void datetime_holiday_test(void)
+{
+	datetime_holiday_rule_test();
+	datetime_holiday_calendar_test();
+}
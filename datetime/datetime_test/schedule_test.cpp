@@ -0,0 +1,178 @@
+// schedule_test.cpp - test periodic schedules
+#include <cmath>
+#include <thread>
+#include "../../include/ensure.h"
+#include "../calendar.h"
+#include "../schedule.h"
+
+using namespace datetime;
+
+void datetime_periodic_schedule_test(void)
+{
+	interval q(3, UNIT_MONTHS, DCB_ACTUAL_360, ROLL_MODIFIED_FOLLOWING, CALENDAR_NONE);
+
+	// regular
+	{
+		periodic_schedule s(day(2012, 3, 20), day(2017, 3, 20), q);
+		ensure (s.size() == 20);
+		ensure (s.unadjusted.size() == 21 && s.adjusted.size() == 21 && s.payment.size() == 20);
+		double dcf = 0;
+		for (size_t i = 0; i < s.size(); ++i) {
+			ensure (s.unadjusted[i] == day(2012, 3, 20).add_months(3*static_cast<int>(i)));
+			ensure (s.adjusted[i + 1].to_date().is_bday());
+			ensure (s.payment[i] == s.adjusted[i + 1]);
+			ensure (s.dcf[i] == (s.adjusted[i + 1] - s.adjusted[i])/360.);
+			dcf += s.dcf[i];
+		}
+		ensure (fabs(dcf - (s.adjusted[20] - s.adjusted[0])/360.) < 1e-12);
+		ensure (s.adjusted[1] == day(2012, 6, 20));
+		// Saturday
+		ensure (s.unadjusted[10] == day(2014, 9, 20) && s.adjusted[10] == day(2014, 9, 22));
+	}
+
+	// stubs
+	{
+		day eff(2012, 2, 1), term(2013, 3, 20);
+		periodic_schedule sf(eff, term, q, STUB_SHORT_FRONT);
+		ensure (sf.size() == 5);
+		ensure (sf.unadjusted[0] == eff && sf.unadjusted[1] == day(2012, 3, 20));
+		ensure (sf.unadjusted[5] == term);
+
+		periodic_schedule lf(eff, term, q, STUB_LONG_FRONT);
+		ensure (lf.size() == 4);
+		ensure (lf.unadjusted[0] == eff && lf.unadjusted[1] == day(2012, 6, 20));
+
+		periodic_schedule sb(eff, term, q, STUB_SHORT_BACK);
+		ensure (sb.size() == 5);
+		ensure (sb.unadjusted[4] == day(2013, 2, 1) && sb.unadjusted[5] == term);
+
+		periodic_schedule lb(eff, term, q, STUB_LONG_BACK);
+		ensure (lb.size() == 4);
+		ensure (lb.unadjusted[3] == day(2012, 11, 1) && lb.unadjusted[4] == term);
+	}
+
+	// no stub
+	{
+		day eff(2012, 1, 15), term(2013, 1, 15);
+		for (int stub = STUB_SHORT_FRONT; stub < STUB_MAX; ++stub) {
+			periodic_schedule s(eff, term, q, static_cast<stub_convention>(stub));
+			ensure (s.size() == 4);
+			for (size_t i = 0; i <= s.size(); ++i)
+				ensure (s.unadjusted[i] == eff.add_months(3*static_cast<int>(i)));
+		}
+	}
+
+	// end of month and payment lag
+	{
+		interval m(1, UNIT_MONTHS, DCB_30U_360, ROLL_NONE, CALENDAR_NONE);
+		periodic_schedule s(day(2012, 1, 31), day(2012, 6, 30), m, STUB_SHORT_BACK, 2, true);
+		ensure (s.size() == 5);
+		ensure (s.unadjusted[1] == day(2012, 2, 29));
+		ensure (s.unadjusted[2] == day(2012, 3, 31));
+		ensure (s.unadjusted[3] == day(2012, 4, 30));
+		ensure (s.adjusted[2] == day(2012, 3, 31)); // Saturday, no roll
+		ensure (s.payment[1] == day(2012, 4, 3));
+
+		// roll from the anchor date
+		periodic_schedule t(day(2012, 4, 30), day(2012, 8, 30), m, STUB_SHORT_BACK);
+		ensure (t.unadjusted[1] == day(2012, 5, 30));
+		periodic_schedule u(day(2012, 4, 30), day(2012, 8, 31), m, STUB_SHORT_BACK, 0, true);
+		ensure (u.unadjusted[1] == day(2012, 5, 31));
+	}
+
+	// weeks
+	{
+		interval w(2, UNIT_WEEKS, DCB_ACTUAL_365, ROLL_FOLLOWING_BUSINESS, CALENDAR_NONE);
+		periodic_schedule s(day(2012, 1, 2), day(2012, 3, 26), w, STUB_SHORT_BACK);
+		ensure (s.size() == 6);
+		for (size_t i = 0; i < s.size(); ++i)
+			ensure (s.unadjusted[i + 1] - s.unadjusted[i] == 14);
+	}
+}
+
+void datetime_schedule_cache_test(void)
+{
+	date eff(2012, 3, 20);
+	bitmap_calendar nyb(calendar::NYB, 2000, 2050, "NYB");
+	schedule_cache c(2);
+
+	schedule_cache::value_type s0 = c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYS);
+	ensure (c.misses() == 1 && c.hits() == 0);
+	ensure (*s0 == schedule(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYS));
+	ensure (c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYS) == s0);
+	ensure (c.misses() == 1 && c.hits() == 1);
+
+	// different calendar
+	schedule_cache::value_type s1 = c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYB);
+	ensure (s1.get() != s0.get());
+	ensure (c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, nyb).get() != s1.get());
+	ensure (c.misses() == 3 && c.size() == 2);
+
+	// least recently used is evicted
+	ensure (c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYS).get() != s0.get());
+	ensure (c.misses() == 4);
+	ensure (*s0 == *c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYS));
+	ensure (c.hits() == 2);
+
+	// not cached
+	c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_NONE, CALENDAR_NONE);
+	c.get(eff, 5, UNIT_YEARS, FREQ_QUARTERLY, ROLL_NONE, CALENDAR_NONE);
+	ensure (c.misses() == 6 && c.size() == 2);
+
+	c.clear();
+	ensure (c.size() == 0 && c.hits() == 0 && c.misses() == 0);
+
+	// same name with different holidays
+	{
+		schedule_cache c(8);
+		bitmap_calendar nyb2([](const date& d) {
+			return calendar::NYB(d) || d == date(2012, 6, 20);
+		}, 2000, 2050, "NYB");
+
+		schedule_cache::value_type s0 = c.get(eff, 1, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, nyb);
+		schedule_cache::value_type s1 = c.get(eff, 1, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, nyb2);
+		ensure (c.misses() == 2 && c.size() == 2);
+		ensure ((*s0)[1] == date(2012, 6, 20));
+		ensure ((*s1)[1] == date(2012, 6, 21));
+
+		// copies share the bitmaps
+		bitmap_calendar nyb3(nyb);
+		ensure (c.get(eff, 1, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, nyb3) == s0);
+		ensure (c.hits() == 1);
+	}
+}
+
+// many trades with few distinct schedules
+// distinct is not a multiple of the number of threads so every thread asks for every schedule
+void datetime_schedule_cache_threads_test(size_t trades = 2000, int distinct = 21)
+{
+	schedule_cache c;
+	std::vector<schedule_cache::value_type> v(trades);
+
+	std::vector<std::thread> th;
+	for (size_t k = 0; k < 4; ++k) {
+		th.push_back(std::thread([&c,&v,k,trades,distinct]() {
+			for (size_t i = k; i < trades; i += 4)
+				v[i] = c.get(date(2012, 1, 3 + i%distinct), 10, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYB);
+		}));
+	}
+	for (size_t k = 0; k < th.size(); ++k)
+		th[k].join();
+
+	ensure (c.hits() + c.misses() == trades);
+	ensure (c.size() == static_cast<size_t>(distinct));
+	// at most one miss per thread for each schedule
+	ensure (c.misses() <= static_cast<size_t>(distinct)*th.size());
+	// threads that lose the race get the schedule already in the cache
+	for (size_t i = 0; i < trades; ++i)
+		ensure (v[i] == v[i%distinct]);
+	for (int i = 0; i < distinct; ++i)
+		ensure (*v[i] == schedule(date(2012, 1, 3 + i), 10, UNIT_YEARS, FREQ_QUARTERLY, ROLL_MODIFIED_FOLLOWING, calendar::NYB));
+}
+
+void datetime_schedule_test(void)
+{
+	datetime_periodic_schedule_test();
+	datetime_schedule_cache_test();
+	datetime_schedule_cache_threads_test();
+}
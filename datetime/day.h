@@ -0,0 +1,143 @@
+// day.h - calendar days as 32 bit serial numbers
+// Copyright (c) 2011 KALX, LLC. All rights reserved. No warranty is made.
+// A day is the number of days since 1970-01-01 with no time of day or
+// time zone, so arithmetic is integer arithmetic and y/m/d conversion
+// is constexpr. Use date when the time of day matters.
+#pragma once
+#include <cstdint>
+#include <limits>
+#include "datetime.h"
+
+namespace datetime {
+
+	class day {
+		int32_t d_;
+	public:
+		// invalid day
+		constexpr day()
+			: d_(std::numeric_limits<int32_t>::min())
+		{ }
+		// days since 1970-01-01
+		constexpr explicit day(int32_t d)
+			: d_(d)
+		{ }
+		// out of range months and days are normalized like mktime
+		constexpr day(int y, int m, int d)
+			: d_(days_from_civil(y + floor_div(m - 1, 12), m - 12*floor_div(m - 1, 12), d))
+		{ }
+		// Excel serial date, time of day is truncated
+		constexpr explicit day(double excel)
+			: d_(static_cast<int32_t>(excel) - 25569) // EXCEL_19700101
+		{ }
+		explicit day(const date& d)
+			: d_(d.days())
+		{ }
+
+		constexpr bool is_valid() const
+		{
+			return d_ != std::numeric_limits<int32_t>::min();
+		}
+		constexpr int32_t serial() const
+		{
+			return d_;
+		}
+		constexpr double excel() const
+		{
+			return d_ + 25569.; // EXCEL_19700101
+		}
+		date to_date() const
+		{
+			return date(1970, 1, 1 + d_);
+		}
+
+		constexpr int year() const
+		{
+			return year_from_days(d_);
+		}
+		constexpr int month() const
+		{
+			return month_from_days(d_);
+		}
+		// day of the month
+		constexpr int mday() const
+		{
+			return day_from_days(d_);
+		}
+		// Sunday = 0
+		constexpr int weekday() const
+		{
+			return weekday_from_days(d_);
+		}
+		// date in YYYYMMDD format
+		constexpr int ymd() const
+		{
+			return year()*10000 + month()*100 + mday();
+		}
+		constexpr bool is_leap() const
+		{
+			return is_leap_year(year());
+		}
+		constexpr int days_in_month() const
+		{
+			return datetime::days_in_month(year(), month());
+		}
+
+		// same day of month n months later or end of month if past it
+		constexpr day add_months(int n) const
+		{
+			return day(datetime::add_months(d_, n));
+		}
+		constexpr day add_years(int n) const
+		{
+			return add_months(12*n);
+		}
+
+		day& operator+=(int n)
+		{
+			d_ += n;
+
+			return *this;
+		}
+		day& operator-=(int n)
+		{
+			d_ -= n;
+
+			return *this;
+		}
+
+		friend constexpr day operator+(day d, int n) { return day(d.d_ + n); }
+		friend constexpr day operator+(int n, day d) { return day(d.d_ + n); }
+		friend constexpr day operator-(day d, int n) { return day(d.d_ - n); }
+		// number of days from d0 to d1
+		friend constexpr int operator-(day d1, day d0) { return d1.d_ - d0.d_; }
+
+		friend constexpr bool operator==(day d0, day d1) { return d0.d_ == d1.d_; }
+		friend constexpr bool operator!=(day d0, day d1) { return d0.d_ != d1.d_; }
+		friend constexpr bool operator<(day d0, day d1) { return d0.d_ < d1.d_; }
+		friend constexpr bool operator<=(day d0, day d1) { return d0.d_ <= d1.d_; }
+		friend constexpr bool operator>(day d0, day d1) { return d0.d_ > d1.d_; }
+		friend constexpr bool operator>=(day d0, day d1) { return d0.d_ >= d1.d_; }
+	};
+
+	// first n IMM dates on or after z in months that are multiples of step
+	inline void
+	imm_dates(day z, size_t n, day* imm, int step = 3)
+	{
+		int m = imm_month(z.serial(), step);
+
+		for (size_t i = 0; i < n; ++i, m += step)
+			imm[i] = day(imm_date(m/12, m%12 + 1));
+	}
+
+	template<> inline day
+	date_convert<day>::encode(date d)
+	{
+		return day(d);
+	}
+	template<> inline date
+	date_convert<day>::decode(day d)
+	{
+		return d.to_date();
+	}
+
+} // namespace datetime
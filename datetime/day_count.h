@@ -0,0 +1,148 @@
+// day_count.h - day count fractions on serial days
+// Copyright (c) 2011 KALX, LLC. All rights reserved. No warranty is made.
+// Same conventions as date::diff_dcb but on days since 1970-01-01
+// so no dates need to be broken out by the C library.
+#pragma once
+#include <limits>
+#include "day.h"
+
+namespace datetime {
+
+	namespace detail {
+
+		// civil_from_days without branches for days on or after 0000-03-01
+		inline void ymd(int32_t z, int& y, int& m, int& d)
+		{
+			unsigned zz = static_cast<unsigned>(z + 719468);
+			unsigned era = zz/146097;
+			unsigned doe = zz - era*146097;
+			unsigned yoe = (doe - doe/1460 + doe/36524 - doe/146096)/365;
+			unsigned doy = doe - (365*yoe + yoe/4 - yoe/100);
+			unsigned mp = (5*doy + 2)/153;
+
+			d = static_cast<int>(doy - (153*mp + 2)/5 + 1);
+			m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+			y = static_cast<int>(era*400 + yoe) + (m <= 2);
+		}
+
+		// days from 1970-01-01 to January 1 of year y > 0
+		inline int32_t jan1(int y)
+		{
+			unsigned yy = static_cast<unsigned>(y - 1); // March based year
+			unsigned era = yy/400;
+			unsigned yoe = yy - era*400;
+
+			return static_cast<int32_t>(era*146097 + 365*yoe + yoe/4 - yoe/100 + 306) - 719468;
+		}
+
+		inline double dcf_30_360(int32_t z0, int32_t z1, bool us)
+		{
+			int y0, m0, d0, y1, m1, d1;
+
+			ymd(z0, y0, m0, d0);
+			ymd(z1, y1, m1, d1);
+
+			d1 = d1 == 31 && (!us || d0 >= 30) ? 30 : d1;
+			d0 = d0 == 31 ? 30 : d0;
+
+			return (360*(y1 - y0) + 30*(m1 - m0) + d1 - d0)/360.;
+		}
+
+		// whole years plus the fractions of the first and last year, also for z1 < z0
+		inline double dcf_actual_actual(int32_t z0, int32_t z1)
+		{
+			int y, m, d;
+
+			ymd(z0, y, m, d);
+			int32_t a0 = jan1(y), b0 = jan1(y + 1);
+			int y0 = y;
+			ymd(z1, y, m, d);
+			int32_t a1 = jan1(y), b1 = jan1(y + 1);
+
+			return (y - y0 - 1) + double(b0 - z0)/(b0 - a0) + double(z1 - a1)/(b1 - a1);
+		}
+
+	} // namespace detail
+
+	// 30/360 with the end of month rule for the day of month of both dates
+	inline double
+	year_fraction_30_360(int32_t d0, int32_t d1, bool us)
+	{
+		return detail::dcf_30_360(d0, d1, us);
+	}
+
+	// actual days in each calendar year over days in that year
+	inline double
+	year_fraction_actual_actual(int32_t d0, int32_t d1)
+	{
+		return detail::dcf_actual_actual(d0, d1);
+	}
+
+	// year fraction from d0 to d1
+	inline double
+	year_fraction(int32_t d0, int32_t d1, day_count_basis dcb)
+	{
+		switch (dcb) {
+		case DCB_ACTUAL_YEARS:
+			return (d1 - d0)/DAYS_PER_YEAR;
+		case DCB_30U_360:
+			return year_fraction_30_360(d0, d1, true);
+		case DCB_30E_360:
+			return year_fraction_30_360(d0, d1, false);
+		case DCB_ACTUAL_360:
+			return (d1 - d0)/360.;
+		case DCB_ACTUAL_365:
+			return (d1 - d0)/365.;
+		case DCB_ACTUAL_ACTUAL_ISDA:
+		case DCB_ACTUAL_ACTUAL_ICMA: // same as date::diff_actual_actual_icma
+			return year_fraction_actual_actual(d0, d1);
+		default:
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+	}
+	inline double
+	year_fraction(day d0, day d1, day_count_basis dcb)
+	{
+		return year_fraction(d0.serial(), d1.serial(), dcb);
+	}
+
+	// t[i] = year_fraction(d0[i], d1[i], dcb) for i = 0,...,n-1
+	// The basis is switched on once and each loop is free of branches and calls
+	// so the compiler can vectorize it.
+	inline void
+	year_fraction(size_t n, const int32_t* d0, const int32_t* d1, day_count_basis dcb, double* t)
+	{
+		double c; // days per year
+
+		switch (dcb) {
+		case DCB_ACTUAL_YEARS:
+			c = DAYS_PER_YEAR;
+			break;
+		case DCB_30U_360:
+			for (size_t i = 0; i < n; ++i)
+				t[i] = detail::dcf_30_360(d0[i], d1[i], true);
+			return;
+		case DCB_30E_360:
+			for (size_t i = 0; i < n; ++i)
+				t[i] = detail::dcf_30_360(d0[i], d1[i], false);
+			return;
+		case DCB_ACTUAL_360:
+			c = 360;
+			break;
+		case DCB_ACTUAL_365:
+			c = 365;
+			break;
+		case DCB_ACTUAL_ACTUAL_ISDA:
+		case DCB_ACTUAL_ACTUAL_ICMA:
+			for (size_t i = 0; i < n; ++i)
+				t[i] = detail::dcf_actual_actual(d0[i], d1[i]);
+			return;
+		default:
+			c = std::numeric_limits<double>::quiet_NaN();
+		}
+
+		for (size_t i = 0; i < n; ++i)
+			t[i] = (d1[i] - d0[i])/c;
+	}
+
+} // namespace datetime
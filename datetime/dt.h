@@ -43,15 +43,190 @@ namespace datetime {
 		return y * DAYS_PER_YEAR + epoch;
 	}
 
+	// thread safe ::localtime
+	inline bool
+	localtime(time_t t, struct tm* ptm)
+	{
+#ifdef _WIN32
+		return 0 == ::localtime_s(ptm, &t);
+#else
+		return 0 != ::localtime_r(&t, ptm);
+#endif
+	}
+
 	// daylight savings time adjustment
 	inline long 
 	dst(time_t t) 
 	{
-		struct tm* ptm;
+		struct tm tm;
+		bool ok = localtime(t, &tm); // too slow!!!
 		
-		ensure (0 != (ptm = ::localtime(&t))); // too slow!!!
+		ensure (ok);
+		(void)ok; // ensure may be empty
 
-		return ptm->tm_isdst*3600;
+		return tm.tm_isdst*3600;
+	}
+
+	// Civil calendar algorithms for the proleptic Gregorian calendar.
+	// http://howardhinnant.github.io/date_algorithms.html
+	// Days are counted from 1970-01-01 and years start in March
+	// so leap days come at the end of the 400 year era.
+
+	// floor(a/b) for b > 0
+	constexpr int
+	floor_div(int a, int b)
+	{
+		return a >= 0 ? a/b : -((b - 1 - a)/b);
+	}
+
+	namespace civil {
+
+		// day of the March based year
+		constexpr int doy(int m, int d)
+		{
+			return (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d - 1;
+		}
+		// day of the 400 year era
+		constexpr int doe(int yoe, int doy)
+		{
+			return yoe*365 + yoe/4 - yoe/100 + doy;
+		}
+		constexpr int days(int y, int m, int d)
+		{
+			return floor_div(y, 400)*146097 + doe(y - floor_div(y, 400)*400, doy(m, d)) - 719468;
+		}
+
+		constexpr int era(int z)
+		{
+			return floor_div(z + 719468, 146097);
+		}
+		constexpr int doe(int z)
+		{
+			return z + 719468 - era(z)*146097;
+		}
+		constexpr int yoe(int doe)
+		{
+			return (doe - doe/1460 + doe/36524 - doe/146096)/365;
+		}
+		constexpr int doy(int doe)
+		{
+			return doe - (365*yoe(doe) + yoe(doe)/4 - yoe(doe)/100);
+		}
+		constexpr int mp(int doy)
+		{
+			return (5*doy + 2)/153;
+		}
+
+	} // namespace civil
+
+	// days since 1970-01-01
+	constexpr int
+	days_from_civil(int y, int m, int d)
+	{
+		return civil::days(y - (m <= 2), m, d);
+	}
+
+	constexpr int
+	month_from_days(int z)
+	{
+		return civil::mp(civil::doy(civil::doe(z))) + (civil::mp(civil::doy(civil::doe(z))) < 10 ? 3 : -9);
+	}
+	constexpr int
+	day_from_days(int z)
+	{
+		return civil::doy(civil::doe(z)) - (153*civil::mp(civil::doy(civil::doe(z))) + 2)/5 + 1;
+	}
+	constexpr int
+	year_from_days(int z)
+	{
+		return civil::yoe(civil::doe(z)) + civil::era(z)*400 + (month_from_days(z) <= 2);
+	}
+	// months since January of year 0
+	constexpr int
+	months_from_days(int z)
+	{
+		return 12*year_from_days(z) + month_from_days(z) - 1;
+	}
+
+	inline void
+	civil_from_days(int z, int* py, int* pm, int* pd)
+	{
+		z += 719468;
+		int era = floor_div(z, 146097);
+		int doe = z - era*146097;                                  // [0, 146096]
+		int yoe = (doe - doe/1460 + doe/36524 - doe/146096)/365; // [0, 399]
+		int doy = doe - (365*yoe + yoe/4 - yoe/100);               // [0, 365]
+		int mp = (5*doy + 2)/153;                                  // [0, 11]
+		int d = doy - (153*mp + 2)/5 + 1;                          // [1, 31]
+		int m = mp + (mp < 10 ? 3 : -9);                           // [1, 12]
+
+		if (py)
+			*py = yoe + era*400 + (m <= 2);
+		if (pm)
+			*pm = m;
+		if (pd)
+			*pd = d;
+	}
+
+	// day of week, Sunday = 0
+	constexpr int
+	weekday_from_days(int z)
+	{
+		return z >= -4 ? (z + 4)%7 : (z + 5)%7 + 6;
+	}
+	// first day on or after z with day of week w
+	constexpr int
+	weekday_on_or_after(int z, int w)
+	{
+		return z + (w - weekday_from_days(z) + 7)%7;
+	}
+	// n-th day of week w in month m of year y, n > 0
+	constexpr int
+	nth_weekday(int y, int m, int n, int w)
+	{
+		return weekday_on_or_after(days_from_civil(y, m, 1), w) + 7*(n - 1);
+	}
+	// IMM date, third Wednesday of month m in year y
+	constexpr int
+	imm_date(int y, int m)
+	{
+		return nth_weekday(y, m, 3, 3);
+	}
+	// months since year 0 of the first IMM date on or after z in months that are
+	// multiples of step, e.g., step 3 for March, June, September and December
+	inline int
+	imm_month(int z, int step = 3)
+	{
+		ensure (0 < step && 12%step == 0);
+
+		int m = months_from_days(z);
+		m += (step - 1 - m%step);
+		if (imm_date(m/12, m%12 + 1) < z)
+			m += step;
+
+		return m;
+	}
+	// first n IMM dates on or after z as days since 1970-01-01
+	// See day.h for the same on days.
+	inline void
+	imm_dates(int z, size_t n, int* imm, int step = 3)
+	{
+		int m = imm_month(z, step);
+
+		for (size_t i = 0; i < n; ++i, m += step)
+			imm[i] = imm_date(m/12, m%12 + 1);
+	}
+
+	constexpr bool
+	is_leap_year(int y)
+	{
+		return y%4 == 0 && (y%100 != 0 || y%400 == 0); 
+	}
+
+	constexpr int
+	days_in_month(int y, int m)
+	{
+		return m == 2 ? 28 + is_leap_year(y) : 30 + ((m + (m >> 3)) & 1);
 	}
 
 	// Excel local time to UTC.
@@ -72,6 +247,33 @@ namespace datetime {
 		return EXCEL_EPOCH + (t - _timezone + (nodst ? 0 : dst(t)))/SECS_PER_DAY; 
 	}
 
+	// day d of month mi since January of year 0, limited to the end of the month
+	constexpr int
+	days_from_months(int mi, int d)
+	{
+		return days_from_civil(floor_div(mi, 12), mi - 12*floor_div(mi, 12) + 1,
+			d < days_in_month(floor_div(mi, 12), mi - 12*floor_div(mi, 12) + 1)
+			? d : days_in_month(floor_div(mi, 12), mi - 12*floor_div(mi, 12) + 1));
+	}
+	// n months after z, the last day of the month if the day of month is past it
+	constexpr int
+	add_months(int z, int n)
+	{
+		return days_from_months(months_from_days(z) + n, day_from_days(z));
+	}
+	// first day of the month n months after z
+	constexpr int
+	first_of_month(int z, int n = 0)
+	{
+		return days_from_months(months_from_days(z) + n, 1);
+	}
+	// last day of the month n months after z
+	constexpr int
+	end_of_month(int z, int n = 0)
+	{
+		return days_from_months(months_from_days(z) + n + 1, 1) - 1;
+	}
+
 	// breakdown double of the form yyyymmdd.hhnnss
 	inline void
 	breakdown(double d, int* py = 0, int* pm = 0, int* pd = 0, int* ph = 0, int* pn = 0, int* ps = 0)
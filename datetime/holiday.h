@@ -7,189 +7,273 @@
 namespace datetime {
 namespace holiday {
 
-	// http://www.assa.org.au/edm.html#Computer
+	// Holiday rules as days since 1970-01-01 that can be evaluated at compile time.
+	namespace serial {
+
+		// Saturday and Sunday to the following Monday
+		constexpr int following(int z)
+		{
+			return z + 2*(weekday_from_days(z) == DAY_SAT) + (weekday_from_days(z) == DAY_SUN);
+		}
+		// Saturday to Friday and Sunday to Monday
+		constexpr int observed(int z)
+		{
+			return z - (weekday_from_days(z) == DAY_SAT) + (weekday_from_days(z) == DAY_SUN);
+		}
+
+		namespace detail {
+
+			// anonymous Gregorian algorithm, Meeus/Jones/Butcher
+			constexpr int easter_h(int y)
+			{
+				return (19*(y%19) + y/100 - y/400 - (y/100 - (y/100 + 8)/25 + 1)/3 + 15)%30;
+			}
+			constexpr int easter_l(int y, int h)
+			{
+				return (32 + 2*(y/100%4) + 2*(y%100/4) - h - y%100%4)%7;
+			}
+			// days after March 22
+			constexpr int easter_offset(int y, int h, int l)
+			{
+				return h + l - 7*((y%19 + 11*h + 22*l)/451);
+			}
+
+		} // namespace detail
+
+		constexpr int easter(int y)
+		{
+			return days_from_civil(y, MONTH_MAR, 22) + detail::easter_offset(y, detail::easter_h(y), detail::easter_l(y, detail::easter_h(y)));
+		}
+		constexpr int good_friday(int y)
+		{
+			return easter(y) - 2;
+		}
+		constexpr int easter_monday(int y)
+		{
+			return easter(y) + 1;
+		}
+
+		// standard holidays
+		constexpr int new_years_day(int y)
+		{
+			return following(days_from_civil(y, MONTH_JAN, 1));
+		}
+		constexpr int martin_luther_kings_birthday(int y)
+		{
+			return nth_weekday(y, MONTH_JAN, 3, DAY_MON);
+		}
+		constexpr int presidents_day(int y)
+		{
+			return nth_weekday(y, MONTH_FEB, 3, DAY_MON);
+		}
+		constexpr int st_patricks_day(int y)
+		{
+			return days_from_civil(y, MONTH_MAR, 17);
+		}
+		constexpr int may_day(int y)
+		{
+			return following(days_from_civil(y, MONTH_MAY, 1));
+		}
+		constexpr int may_day_bank_holiday(int y)
+		{
+			return nth_weekday(y, MONTH_MAY, 1, DAY_MON);
+		}
+		// last Monday in May
+		constexpr int memorial_day(int y)
+		{
+			return weekday_on_or_after(days_from_civil(y, MONTH_MAY, 25), DAY_MON);
+		}
+		constexpr int spring_bank_holiday(int y)
+		{
+			return weekday_on_or_after(days_from_civil(y, MONTH_MAY, 25), DAY_MON);
+		}
+		constexpr int june_bank_holiday(int y)
+		{
+			return nth_weekday(y, MONTH_JUN, 1, DAY_MON);
+		}
+		constexpr int independence_day(int y)
+		{
+			return observed(days_from_civil(y, MONTH_JUL, 4));
+		}
+		constexpr int summer_bank_holiday(int y)
+		{
+			return weekday_on_or_after(days_from_civil(y, MONTH_AUG, 25), DAY_MON); //???
+		}
+		constexpr int labor_day(int y)
+		{
+			return nth_weekday(y, MONTH_SEP, 1, DAY_MON);
+		}
+		constexpr int columbus_day(int y)
+		{
+			return nth_weekday(y, MONTH_OCT, 2, DAY_MON);
+		}
+		constexpr int veterans_day(int y)
+		{
+			return observed(days_from_civil(y, MONTH_NOV, 11));
+		}
+		constexpr int thanksgiving_day(int y)
+		{
+			return nth_weekday(y, MONTH_NOV, 4, DAY_THU);
+		}
+		constexpr int christmas_day(int y)
+		{
+			return observed(days_from_civil(y, MONTH_DEC, 25));
+		}
+		constexpr int boxing_day(int y)
+		{
+			return observed(days_from_civil(y, MONTH_DEC, 26));
+		}
+
+	} // namespace serial
+
+	// years with precomputed holidays
+	static const int YEAR_MIN = 1970;
+	static const int YEAR_MAX = 2201; // one past the last year
+
+	namespace detail {
+
+		template<int... I>
+		struct index_sequence { };
+		template<int N, int... I>
+		struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> { };
+		template<int... I>
+		struct make_index_sequence<0, I...> {
+			typedef index_sequence<I...> type;
+		};
+
+		template<int (*F)(int), class S>
+		struct table_;
+		template<int (*F)(int), int... I>
+		struct table_<F, index_sequence<I...>> {
+			static constexpr int value[sizeof...(I)] = { F(YEAR_MIN + I)... };
+		};
+		template<int (*F)(int), int... I>
+		constexpr int table_<F, index_sequence<I...>>::value[sizeof...(I)];
+
+	} // namespace detail
+
+	// rule F for years YEAR_MIN to YEAR_MAX - 1 computed at compile time
+	template<int (*F)(int)>
+	struct table : detail::table_<F, typename detail::make_index_sequence<YEAR_MAX - YEAR_MIN>::type> { };
+
+	// holiday F in year y from the table if possible
+	template<int (*F)(int)>
+	inline int lookup(int y)
+	{
+		return YEAR_MIN <= y && y < YEAR_MAX ? table<F>::value[y - YEAR_MIN] : F(y);
+	}
+
 	inline
 	void easter_month_day(int y, int& m, int& d)
 	{
-		int fd, r, t;    // intermediate results
-		int tA, tB, tC, tD, tE;          // table A to E results
-
-		   fd = y / 100;              // first 2 digits of year
-		   r = y % 19;             // remainder of year / 19
-
-		//  calculate PFM date
-		   t = (fd - 15) / 2 + 202 - 11 * r;
-    
-		   switch (fd) {
-			  case 21: case 24: case 25: case 27: case 28: case 29: case 30: case 31: case 32: case 34: case 35: case 38:
-				 t = t - 1;
-
-				  break;
-			  case 33: case 36: case 37: case 39: case 40:
-				 t = t - 2;
-
-				 break;
-		   }
-		   t = t % 30;
-
-		   tA = t + 21;
-		   if (t == 29) tA = tA - 1;
-		   if (t == 28 && r > 10) tA = tA - 1;
-
-		// find the next Sunday
-		   tB = (tA - 19) % 7;
-    
-		   tC = (40 - fd) % 4;
-		   if (tC == 3) tC = tC + 1;
-		   if (tC > 1) tC = tC + 1;
-        
-		   t = y % 100;
-		   tD = (t + t / 4) % 7;
-    
-		   tE = ((20 - tB - tC - tD) % 7) + 1;
-		   d = tA + tE;
-
-		// return the date
-		   if (d > 31) {
-			  d = d - 31;
-			  m = 4;
-		   }
-		   else {
-			  m = 3;
-		   }
-
-		   ensure (DAY_SUN == datetime::date(y,m,d).weekday());
+		int z = lookup<serial::easter>(y);
+
+		m = month_from_days(z);
+		d = day_from_days(z);
 	}
 
 	// standard holidays
-	inline datetime::date 
+	inline datetime::date
 	new_years_day(int year)
 	{
-		return datetime::date(year, MONTH_JAN, 1).adjust(ROLL_FOLLOWING_BUSINESS);
+		return datetime::date(1970, 1, 1 + lookup<serial::new_years_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	martin_luther_kings_birthday(int year)
 	{
-		return datetime::date(year, MONTH_JAN, 1).imm(3, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::martin_luther_kings_birthday>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	presidents_day(int year)
 	{
-		return datetime::date(year, MONTH_FEB, 1).imm(3, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::presidents_day>(year));
 	}
 	inline datetime::date
 	st_patricks_day(int year)
 	{
-		return datetime::date(year, MONTH_MAR, 17);
+		return datetime::date(1970, 1, 1 + lookup<serial::st_patricks_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	good_friday(int y)
 	{
-		int m, d;
-
-		easter_month_day(y, m, d);
-
-		return datetime::date(y, m, d - 2);
+		return datetime::date(1970, 1, 1 + lookup<serial::good_friday>(y));
 	}
-	inline datetime::date 
+	inline datetime::date
 	easter(int y)
 	{
-		int m, d;
-
-		easter_month_day(y, m, d);
-
-		return datetime::date(y, m, d);
+		return datetime::date(1970, 1, 1 + lookup<serial::easter>(y));
 	}
-	inline datetime::date 
+	inline datetime::date
 	easter_monday(int y)
 	{
-		int m, d;
-
-		easter_month_day(y, m, d);
-
-		return datetime::date(y, m, d + 1);
+		return datetime::date(1970, 1, 1 + lookup<serial::easter_monday>(y));
 	}
-	inline datetime::date 
+	inline datetime::date
 	may_day(int year)
 	{
-		datetime::date d(year, MONTH_MAY, 1);
-		int wday = d.weekday();
-
-		return wday == DAY_SAT ? d.incr(2, UNIT_DAY) : wday == DAY_SUN ? d.incr(1, UNIT_DAY) : d;
+		return datetime::date(1970, 1, 1 + lookup<serial::may_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	may_day_bank_holiday(int year)
 	{
-		return datetime::date(year, MONTH_MAY, 1).imm(1, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::may_day_bank_holiday>(year));
 	}
 	// last Monday in May
-	inline datetime::date 
+	inline datetime::date
 	memorial_day(int year)
 	{
-		return datetime::date(year, MONTH_MAY, 25).imm(0, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::memorial_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	spring_bank_holiday(int year)
 	{
-		return datetime::date(year, MONTH_MAY, 25).imm(0, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::spring_bank_holiday>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	june_bank_holiday(int year)
 	{
-		return datetime::date(year, MONTH_JUN, 1).imm(1, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::june_bank_holiday>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	independence_day(int year)
 	{
-		datetime::date d(year, MONTH_JUL, 4);
-		int wday = d.weekday();
-
-		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+		return datetime::date(1970, 1, 1 + lookup<serial::independence_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	summer_bank_holiday(int year)
 	{
-		return datetime::date(year, MONTH_AUG, 25).imm(0, DAY_MON); //???
+		return datetime::date(1970, 1, 1 + lookup<serial::summer_bank_holiday>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	labor_day(int year)
 	{
-		return datetime::date(year, MONTH_SEP, 1).imm(1, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::labor_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	columbus_day(int year)
 	{
-		return datetime::date(year, MONTH_OCT, 1).imm(2, DAY_MON);
+		return datetime::date(1970, 1, 1 + lookup<serial::columbus_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	veterans_day(int year)
 	{
-		datetime::date d(year, MONTH_NOV, 11);
-		int wday = d.weekday();
-
-		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+		return datetime::date(1970, 1, 1 + lookup<serial::veterans_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	thanksgiving_day(int year)
 	{
-		return datetime::date(year, MONTH_NOV, 1).imm(4, DAY_THU);
+		return datetime::date(1970, 1, 1 + lookup<serial::thanksgiving_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	christmas_day(int year)
 	{
-		datetime::date d(year, MONTH_DEC, 25);
-		int wday = d.weekday();
-
-		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+		return datetime::date(1970, 1, 1 + lookup<serial::christmas_day>(year));
 	}
-	inline datetime::date 
+	inline datetime::date
 	boxing_day(int year)
 	{
-		datetime::date d(year, MONTH_DEC, 26);
-		int wday = d.weekday();
-
-		return wday == DAY_SUN ? d.incr(1, UNIT_DAY) : wday == DAY_SAT ? d.incr(-1, UNIT_DAY) : d;
+		return datetime::date(1970, 1, 1 + lookup<serial::boxing_day>(year));
 	}
 
 } // namespace holiday
-} // namespace datetime
\ No newline at end of file
+} // namespace datetime
@@ -0,0 +1,244 @@
+// schedule.h - periodic schedules as parallel arrays
+// Copyright (c) 2011 KALX, LLC. All rights reserved. No warranty is made.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "datetime.h"
+#include "day.h"
+#include "day_count.h"
+
+namespace datetime {
+
+typedef enum stub_convention {
+	STUB_SHORT_FRONT = 0, // roll back from termination
+	STUB_SHORT_BACK,      // roll forward from effective
+	STUB_LONG_FRONT,
+	STUB_LONG_BACK,
+	STUB_MAX
+};
+
+	// business day adjustment of a day
+	inline day
+	adjust(day d, roll_convention roll, const holiday_calendar& cal = CALENDAR_NONE)
+	{
+		return day(d.to_date().adjust(roll, cal));
+	}
+
+	// Schedule with n periods from the effective date to the termination date.
+	// Period i accrues from adjusted[i] to adjusted[i+1] and pays on payment[i].
+	struct periodic_schedule {
+		std::vector<day> unadjusted; // period boundaries, size n + 1
+		std::vector<day> adjusted;   // size n + 1
+		std::vector<day> payment;    // size n
+		std::vector<double> dcf;     // day count fraction, size n
+
+		periodic_schedule()
+		{ }
+		periodic_schedule(day eff, day term, const interval& i,
+			stub_convention stub = STUB_SHORT_FRONT, int lag = 0, bool eom = false)
+		{
+			generate(eff, term, i, stub, lag, eom);
+		}
+
+		// number of periods
+		size_t size() const
+		{
+			return dcf.size();
+		}
+
+		// Periods of length i.count_ i.unit_ with i.roll_ and i.cal_ adjustment and i.dcb_
+		// day count fractions. Payments are lag business days after the adjusted period end.
+		// If eom is true and the roll date is the end of a month all dates are month ends.
+		periodic_schedule& generate(day eff, day term, const interval& i,
+			stub_convention stub = STUB_SHORT_FRONT, int lag = 0, bool eom = false)
+		{
+			ensure (eff < term);
+			ensure (i.count_ > 0);
+
+			int months = i.unit_ == UNIT_MONTHS ? i.count_ : i.unit_ == UNIT_YEARS ? 12*i.count_ : 0;
+			int days = i.unit_ == UNIT_DAYS ? i.count_ : i.unit_ == UNIT_WEEKS ? 7*i.count_ : 0;
+			ensure (months || days);
+
+			bool back = stub == STUB_SHORT_FRONT || stub == STUB_LONG_FRONT;
+			day d0 = back ? term : eff;
+			int one = back ? -1 : 1;
+			eom = eom && months && d0.mday() == d0.days_in_month();
+
+			// unadjusted dates from the roll date, eff < d < term
+			unadjusted.clear();
+			unadjusted.push_back(d0);
+			bool stubbed; // the roll does not land on the other end
+			for (int k = 1; true; ++k) {
+				day d = months ? d0.add_months(one*k*months) : d0 + one*k*days;
+				if (eom)
+					d = day(d.year(), d.month(), d.days_in_month());
+
+				if (back ? !(eff < d) : !(d < term)) {
+					stubbed = back ? d != eff : d != term;
+					break;
+				}
+
+				unadjusted.push_back(d);
+			}
+			// merge stub into adjacent period
+			if ((stub == STUB_LONG_FRONT || stub == STUB_LONG_BACK) && stubbed && unadjusted.size() > 1)
+				unadjusted.pop_back();
+			unadjusted.push_back(back ? eff : term);
+			if (back)
+				std::reverse(unadjusted.begin(), unadjusted.end());
+
+			size_t n = unadjusted.size() - 1;
+			adjusted.resize(n + 1);
+			payment.resize(n);
+			dcf.resize(n);
+
+			adjusted[0] = adjust(unadjusted[0], i.roll_, i.cal_);
+			for (size_t j = 0; j < n; ++j) {
+				adjusted[j + 1] = adjust(unadjusted[j + 1], i.roll_, i.cal_);
+				payment[j] = lag ? day(adjusted[j + 1].to_date().incr(lag, UNIT_BUSINESS_DAYS, i.cal_)) : adjusted[j + 1];
+				dcf[j] = year_fraction(adjusted[j], adjusted[j + 1], i.dcb_);
+			}
+
+			return *this;
+		}
+	};
+
+	// Bounded least recently used cache of schedule() results shared by all callers.
+	// Calendars are identified by bitmap_calendar data or function pointer,
+	// schedules with any other calendar are generated but not cached.
+	class schedule_cache {
+	public:
+		typedef std::shared_ptr<const std::vector<date>> value_type;
+	private:
+		struct key {
+			int d, s; // effective date
+			int count; time_unit unit;
+			payment_frequency freq;
+			roll_convention roll;
+			uintptr_t cal; // 0 if not cached
+			std::shared_ptr<const void> data; // keeps cal from being reused
+
+			bool operator<(const key& k) const
+			{
+				if (d != k.d) return d < k.d;
+				if (s != k.s) return s < k.s;
+				if (count != k.count) return count < k.count;
+				if (unit != k.unit) return unit < k.unit;
+				if (freq != k.freq) return freq < k.freq;
+				if (roll != k.roll) return roll < k.roll;
+				if (cal != k.cal) return cal < k.cal;
+
+				return data < k.data;
+			}
+		};
+		typedef std::list<std::pair<key, value_type>> list;
+
+		size_t capacity_;
+		std::mutex mutex_;
+		list lru_; // most recently used first
+		std::map<key, list::iterator> map_;
+		std::atomic<size_t> hits_, misses_;
+
+		schedule_cache(const schedule_cache&);
+		schedule_cache& operator=(const schedule_cache&);
+	public:
+		schedule_cache(size_t capacity = 1024)
+			: capacity_(capacity), hits_(0), misses_(0)
+		{
+			ensure (capacity_ > 0);
+		}
+
+		// identity of cal, 0 if it has none
+		static uintptr_t calendar_key(const holiday_calendar& cal, std::shared_ptr<const void>& data)
+		{
+			typedef bool(*calendar_pointer)(const date&);
+
+			if (const bitmap_calendar* b = cal.target<bitmap_calendar>()) {
+				data = b->identity();
+
+				return reinterpret_cast<uintptr_t>(data.get());
+			}
+
+			if (const calendar_pointer* f = cal.target<calendar_pointer>())
+				return reinterpret_cast<uintptr_t>(*f);
+
+			return 0;
+		}
+
+		// same as schedule(eff, count, unit, freq, roll, cal)
+		value_type get(const date& eff, int count, time_unit unit,
+			payment_frequency freq, roll_convention roll, const holiday_calendar& cal)
+		{
+			key k = {eff.days(), eff.seconds(), count, unit, freq, roll, 0, 0};
+			k.cal = calendar_key(cal, k.data);
+
+			if (k.cal) {
+				std::lock_guard<std::mutex> lock(mutex_);
+
+				auto i = map_.find(k);
+				if (i != map_.end()) {
+					lru_.splice(lru_.begin(), lru_, i->second);
+					++hits_;
+
+					return i->second->second;
+				}
+			}
+			++misses_;
+
+			// generate outside of the lock
+			value_type v = std::make_shared<const std::vector<date>>(schedule(eff, count, unit, freq, roll, cal));
+
+			if (k.cal) {
+				std::lock_guard<std::mutex> lock(mutex_);
+
+				auto i = map_.find(k);
+				if (i != map_.end()) // another thread got here first
+					return i->second->second;
+
+				lru_.push_front(std::make_pair(k, v));
+				map_.insert(std::make_pair(k, lru_.begin()));
+				if (lru_.size() > capacity_) {
+					map_.erase(lru_.back().first);
+					lru_.pop_back();
+				}
+			}
+
+			return v;
+		}
+
+		size_t capacity(void) const
+		{
+			return capacity_;
+		}
+		size_t size(void)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			return lru_.size();
+		}
+		size_t hits(void) const
+		{
+			return hits_;
+		}
+		size_t misses(void) const
+		{
+			return misses_;
+		}
+		void clear(void)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			map_.clear();
+			lru_.clear();
+			hits_ = 0;
+			misses_ = 0;
+		}
+	};
+
+} // namespace datetime
@@ -0,0 +1,54 @@
+// timer.h - wall clock timer for benchmarks
+// Copyright (c) 2013 KALX, LLC. All rights reserved. No warranty is made.
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace utility {
+
+	class timer {
+		double start_, stop_;
+#ifdef _WIN32
+		static double now(void)
+		{
+			LARGE_INTEGER c, f;
+
+			QueryPerformanceCounter(&c);
+			QueryPerformanceFrequency(&f);
+
+			return static_cast<double>(c.QuadPart)/f.QuadPart;
+		}
+#else
+		static double now(void)
+		{
+			struct timeval tv;
+
+			gettimeofday(&tv, 0);
+
+			return tv.tv_sec + 1e-6*tv.tv_usec;
+		}
+#endif // _WIN32
+	public:
+		timer()
+			: start_(0), stop_(0)
+		{ }
+		void start(void)
+		{
+			start_ = now();
+			stop_ = start_;
+		}
+		void stop(void)
+		{
+			stop_ = now();
+		}
+		// seconds between start and stop
+		double elapsed(void) const
+		{
+			return stop_ - start_;
+		}
+	};
+
+} // namespace utility
@@ -0,0 +1,221 @@
+// dual.h - dual numbers for forward mode automatic differentiation
+// Copyright (c) 2013 KALX, LLC. All rights reserved. No warranty is made.
+// A dual<T,N> carries a value and N tangent directions, so one evaluation
+// of a function templated on its argument type computes N derivatives.
+// Tangents are stored contiguously and updated by simple loops over N.
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace numerical {
+
+	template<class T = double, size_t N = 1>
+	class dual {
+		T x_;
+		T dx_[N];
+	public:
+		// constant
+		dual(T x = 0)
+			: x_(x)
+		{
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] = 0;
+		}
+		// variable with tangent dx in direction i
+		dual(T x, size_t i, T dx = 1)
+			: x_(x)
+		{
+			for (size_t j = 0; j < N; ++j)
+				dx_[j] = 0;
+			dx_[i] = dx;
+		}
+
+		static size_t size(void)
+		{
+			return N;
+		}
+		T value(void) const
+		{
+			return x_;
+		}
+		// derivative in direction i
+		T operator[](size_t i) const
+		{
+			return dx_[i];
+		}
+		T& operator[](size_t i)
+		{
+			return dx_[i];
+		}
+		explicit operator bool() const
+		{
+			return x_ != 0;
+		}
+
+		dual operator-() const
+		{
+			dual y(-x_);
+
+			for (size_t i = 0; i < N; ++i)
+				y.dx_[i] = -dx_[i];
+
+			return y;
+		}
+		dual operator+() const
+		{
+			return *this;
+		}
+
+		dual& operator+=(const dual& y)
+		{
+			x_ += y.x_;
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] += y.dx_[i];
+
+			return *this;
+		}
+		dual& operator+=(T y)
+		{
+			x_ += y;
+
+			return *this;
+		}
+		dual& operator-=(const dual& y)
+		{
+			x_ -= y.x_;
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] -= y.dx_[i];
+
+			return *this;
+		}
+		dual& operator-=(T y)
+		{
+			x_ -= y;
+
+			return *this;
+		}
+		// (x + dx)(y + dy) = xy + (x dy + y dx)
+		dual& operator*=(const dual& y)
+		{
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] = dx_[i]*y.x_ + x_*y.dx_[i];
+			x_ *= y.x_;
+
+			return *this;
+		}
+		dual& operator*=(T y)
+		{
+			x_ *= y;
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] *= y;
+
+			return *this;
+		}
+		// (x + dx)/(y + dy) = x/y + (dx - (x/y) dy)/y
+		dual& operator/=(const dual& y)
+		{
+			x_ /= y.x_;
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] = (dx_[i] - x_*y.dx_[i])/y.x_;
+
+			return *this;
+		}
+		dual& operator/=(T y)
+		{
+			x_ /= y;
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] /= y;
+
+			return *this;
+		}
+
+		friend dual operator+(dual x, const dual& y) { return x += y; }
+		friend dual operator+(dual x, T y) { return x += y; }
+		friend dual operator+(T x, dual y) { return y += x; }
+		friend dual operator-(dual x, const dual& y) { return x -= y; }
+		friend dual operator-(dual x, T y) { return x -= y; }
+		friend dual operator-(T x, const dual& y) { return -y + x; }
+		friend dual operator*(dual x, const dual& y) { return x *= y; }
+		friend dual operator*(dual x, T y) { return x *= y; }
+		friend dual operator*(T x, dual y) { return y *= x; }
+		friend dual operator/(dual x, const dual& y) { return x /= y; }
+		friend dual operator/(dual x, T y) { return x /= y; }
+		friend dual operator/(T x, const dual& y) { return dual(x) /= y; }
+
+		// comparisons use only the value
+		friend bool operator==(const dual& x, const dual& y) { return x.x_ == y.x_; }
+		friend bool operator!=(const dual& x, const dual& y) { return x.x_ != y.x_; }
+		friend bool operator<(const dual& x, const dual& y) { return x.x_ < y.x_; }
+		friend bool operator<=(const dual& x, const dual& y) { return x.x_ <= y.x_; }
+		friend bool operator>(const dual& x, const dual& y) { return x.x_ > y.x_; }
+		friend bool operator>=(const dual& x, const dual& y) { return x.x_ >= y.x_; }
+
+		// f(x + dx) = f(x) + f'(x) dx
+		dual& chain(T fx, T dfx)
+		{
+			x_ = fx;
+			for (size_t i = 0; i < N; ++i)
+				dx_[i] *= dfx;
+
+			return *this;
+		}
+	};
+
+	template<class T, size_t N>
+	inline dual<T,N> exp(dual<T,N> x)
+	{
+		T ex = std::exp(x.value());
+
+		return x.chain(ex, ex);
+	}
+	template<class T, size_t N>
+	inline dual<T,N> log(dual<T,N> x)
+	{
+		return x.chain(std::log(x.value()), 1/x.value());
+	}
+	template<class T, size_t N>
+	inline dual<T,N> sqrt(dual<T,N> x)
+	{
+		T sx = std::sqrt(x.value());
+
+		return x.chain(sx, 1/(2*sx));
+	}
+	template<class T, size_t N>
+	inline dual<T,N> pow(dual<T,N> x, T a)
+	{
+		T xa = std::pow(x.value(), a - 1);
+
+		return x.chain(xa*x.value(), a*xa);
+	}
+	template<class T, size_t N>
+	inline dual<T,N> fabs(dual<T,N> x)
+	{
+		return x.value() < 0 ? -x : x;
+	}
+	template<class T, size_t N>
+	inline dual<T,N> abs(dual<T,N> x)
+	{
+		return fabs(x);
+	}
+
+} // namespace numerical
+
+namespace std {
+
+	template<class T, size_t N>
+	class numeric_limits<numerical::dual<T,N>> : public numeric_limits<T> {
+		typedef numerical::dual<T,N> dual;
+	public:
+		static dual min() { return dual(numeric_limits<T>::min()); }
+		static dual max() { return dual(numeric_limits<T>::max()); }
+		static dual lowest() { return dual(numeric_limits<T>::lowest()); }
+		static dual epsilon() { return dual(numeric_limits<T>::epsilon()); }
+		static dual round_error() { return dual(numeric_limits<T>::round_error()); }
+		static dual infinity() { return dual(numeric_limits<T>::infinity()); }
+		static dual quiet_NaN() { return dual(numeric_limits<T>::quiet_NaN()); }
+		static dual signaling_NaN() { return dual(numeric_limits<T>::signaling_NaN()); }
+		static dual denorm_min() { return dual(numeric_limits<T>::denorm_min()); }
+	};
+
+} // namespace std
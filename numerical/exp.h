@@ -0,0 +1,321 @@
+// exp.h - exponential and logarithm with batch SIMD kernels
+// Copyright (c) 2013 KALX, LLC. All rights reserved. No warranty is made.
+// Batch versions use AVX2 or SSE2 when the compiler targets them, e.g. /arch:AVX2 or -mavx2,
+// and fall back to the scalar kernel otherwise. Results agree with the C library to within 2 ulp.
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#define NUMERICAL_EXP_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NUMERICAL_EXP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace numerical {
+
+	namespace exp_ {
+
+		// Cody-Waite split of log(2)
+		static const double ln2_hi = 6.93147180369123816490e-01;
+		static const double ln2_lo = 1.90821492927058770002e-10;
+		static const double log2e  = 1.44269504088896338700e+00;
+		static const double sqrt2  = 1.41421356237309514547e+00;
+		// x + round_ - round_ rounds to nearest integer for |x| < 2^51
+		static const double round_ = 6755399441055744.0; // 2^52 + 2^51
+
+		// range where exp is a normal double
+		static const double exp_lo = -708;
+		static const double exp_hi = 709;
+
+		// 1/j!, j = 13, ..., 0
+		static const double exp_c[] = {
+			1./6227020800, 1./479001600, 1./39916800, 1./3628800, 1./362880,
+			1./40320, 1./5040, 1./720, 1./120, 1./24, 1./6, 1./2, 1., 1.
+		};
+		// 2/(2j+1), j = 12, ..., 1
+		static const double log_c[] = {
+			2./25, 2./23, 2./21, 2./19, 2./17, 2./15, 2./13, 2./11, 2./9, 2./7, 2./5, 2./3
+		};
+
+		inline std::int64_t bits(double x)
+		{
+			std::int64_t i;
+
+			std::memcpy(&i, &x, sizeof(x));
+
+			return i;
+		}
+		inline double real(std::int64_t i)
+		{
+			double x;
+
+			std::memcpy(&x, &i, sizeof(x));
+
+			return x;
+		}
+
+		// exp(r) for |r| <= log(2)/2
+		inline double exp_reduced(double r)
+		{
+			double p = exp_c[0];
+
+			for (size_t j = 1; j < sizeof(exp_c)/sizeof(*exp_c); ++j)
+				p = p*r + exp_c[j];
+
+			return p;
+		}
+
+		inline double exp(double x)
+		{
+			if (x != x)
+				return x;
+			if (x > exp_hi + 1)
+				return std::numeric_limits<double>::infinity();
+			if (x < exp_lo - 38)
+				return 0;
+
+			double k = (x*log2e + round_) - round_;
+			double r = (x - k*ln2_hi) - k*ln2_lo;
+
+			return std::ldexp(exp_reduced(r), static_cast<int>(k));
+		}
+
+		// log(1 + f) for sqrt(1/2) - 1 <= f < sqrt(2) - 1
+		inline double log1p_reduced(double f)
+		{
+			double s = f/(2 + f);
+			double z = s*s;
+			double R = log_c[0];
+
+			for (size_t j = 1; j < sizeof(log_c)/sizeof(*log_c); ++j)
+				R = R*z + log_c[j];
+			R *= z;
+
+			double hfsq = 0.5*f*f;
+
+			return f - (hfsq - s*(hfsq + R));
+		}
+
+		inline double log(double x)
+		{
+			if (x != x || x == std::numeric_limits<double>::infinity())
+				return x;
+			if (x < 0)
+				return std::numeric_limits<double>::quiet_NaN();
+			if (x == 0)
+				return -std::numeric_limits<double>::infinity();
+
+			int e = 0;
+			if (x < std::numeric_limits<double>::min()) {
+				x *= 18014398509481984.0; // 2^54
+				e = -54;
+			}
+
+			std::int64_t i = bits(x);
+			e += static_cast<int>(i >> 52) - 1023;
+			double m = real((i & 0x000FFFFFFFFFFFFFLL) | 0x3FF0000000000000LL); // 1 <= m < 2
+			if (m > sqrt2) {
+				m *= 0.5;
+				++e;
+			}
+
+			double k = e;
+
+			return k*ln2_hi + (log1p_reduced(m - 1) + k*ln2_lo);
+		}
+
+#if defined(NUMERICAL_EXP_AVX2)
+		typedef __m256d pd;
+		typedef __m256i pi;
+		static const size_t lanes = 4;
+		inline pd load(const double* x) { return _mm256_loadu_pd(x); }
+		inline void store(double* y, pd x) { _mm256_storeu_pd(y, x); }
+		inline pd set1(double x) { return _mm256_set1_pd(x); }
+		inline pd add(pd x, pd y) { return _mm256_add_pd(x, y); }
+		inline pd sub(pd x, pd y) { return _mm256_sub_pd(x, y); }
+		inline pd mul(pd x, pd y) { return _mm256_mul_pd(x, y); }
+		inline pd div(pd x, pd y) { return _mm256_div_pd(x, y); }
+		inline pd and_(pd x, pd y) { return _mm256_and_pd(x, y); }
+		inline pd or_(pd x, pd y) { return _mm256_or_pd(x, y); }
+		// x if mask else y
+		inline pd select(pd mask, pd x, pd y) { return _mm256_blendv_pd(y, x, mask); }
+		inline pd gt(pd x, pd y) { return _mm256_cmp_pd(x, y, _CMP_GT_OQ); }
+		// true if any lane of x is outside [lo, hi] or NaN
+		inline bool outside(pd x, pd lo, pd hi)
+		{
+			return _mm256_movemask_pd(_mm256_or_pd(_mm256_cmp_pd(x, lo, _CMP_NGE_UQ), _mm256_cmp_pd(x, hi, _CMP_NLE_UQ))) != 0;
+		}
+		inline pi cast_i(pd x) { return _mm256_castpd_si256(x); }
+		inline pd cast_d(pi i) { return _mm256_castsi256_pd(i); }
+		inline pi set1_i(std::int64_t i) { return _mm256_set1_epi64x(i); }
+		inline pi add_i(pi i, pi j) { return _mm256_add_epi64(i, j); }
+		inline pi sub_i(pi i, pi j) { return _mm256_sub_epi64(i, j); }
+		inline pi and_i(pi i, pi j) { return _mm256_and_si256(i, j); }
+		inline pi or_i(pi i, pi j) { return _mm256_or_si256(i, j); }
+		inline pi shl_i(pi i, int n) { return _mm256_slli_epi64(i, n); }
+		inline pi shr_i(pi i, int n) { return _mm256_srli_epi64(i, n); }
+#elif defined(NUMERICAL_EXP_SSE2)
+		typedef __m128d pd;
+		typedef __m128i pi;
+		static const size_t lanes = 2;
+		inline pd load(const double* x) { return _mm_loadu_pd(x); }
+		inline void store(double* y, pd x) { _mm_storeu_pd(y, x); }
+		inline pd set1(double x) { return _mm_set1_pd(x); }
+		inline pd add(pd x, pd y) { return _mm_add_pd(x, y); }
+		inline pd sub(pd x, pd y) { return _mm_sub_pd(x, y); }
+		inline pd mul(pd x, pd y) { return _mm_mul_pd(x, y); }
+		inline pd div(pd x, pd y) { return _mm_div_pd(x, y); }
+		inline pd and_(pd x, pd y) { return _mm_and_pd(x, y); }
+		inline pd or_(pd x, pd y) { return _mm_or_pd(x, y); }
+		inline pd select(pd mask, pd x, pd y) { return _mm_or_pd(_mm_and_pd(mask, x), _mm_andnot_pd(mask, y)); }
+		inline pd gt(pd x, pd y) { return _mm_cmpgt_pd(x, y); }
+		inline bool outside(pd x, pd lo, pd hi)
+		{
+			return _mm_movemask_pd(_mm_or_pd(_mm_cmpnge_pd(x, lo), _mm_cmpnle_pd(x, hi))) != 0;
+		}
+		inline pi cast_i(pd x) { return _mm_castpd_si128(x); }
+		inline pd cast_d(pi i) { return _mm_castsi128_pd(i); }
+		inline pi set1_i(std::int64_t i) { return _mm_set1_epi64x(i); }
+		inline pi add_i(pi i, pi j) { return _mm_add_epi64(i, j); }
+		inline pi sub_i(pi i, pi j) { return _mm_sub_epi64(i, j); }
+		inline pi and_i(pi i, pi j) { return _mm_and_si128(i, j); }
+		inline pi or_i(pi i, pi j) { return _mm_or_si128(i, j); }
+		inline pi shl_i(pi i, int n) { return _mm_slli_epi64(i, n); }
+		inline pi shr_i(pi i, int n) { return _mm_srli_epi64(i, n); }
+#endif
+
+#if defined(NUMERICAL_EXP_AVX2) || defined(NUMERICAL_EXP_SSE2)
+		// lanes of exp(x) for exp_lo <= x <= exp_hi
+		inline pd exp(pd x)
+		{
+			pd y = add(mul(x, set1(log2e)), set1(round_));
+			pd k = sub(y, set1(round_));
+			pd r = sub(sub(x, mul(k, set1(ln2_hi))), mul(k, set1(ln2_lo)));
+
+			pd p = set1(exp_c[0]);
+			for (size_t j = 1; j < sizeof(exp_c)/sizeof(*exp_c); ++j)
+				p = add(mul(p, r), set1(exp_c[j]));
+
+			// low bits of y are k, so 2^k has exponent bits k + 1023
+			pi e = sub_i(cast_i(y), cast_i(set1(round_)));
+			pd two_k = cast_d(shl_i(add_i(e, set1_i(1023)), 52));
+
+			return mul(p, two_k);
+		}
+
+		// lanes of log(x) for normal positive x
+		inline pd log(pd x)
+		{
+			pi i = cast_i(x);
+			pi e = shr_i(i, 52); // biased exponent
+			pd m = cast_d(or_i(and_i(i, set1_i(0x000FFFFFFFFFFFFFLL)), set1_i(0x3FF0000000000000LL)));
+
+			// exact int to double for 0 <= e < 2^52
+			pd k = sub(cast_d(or_i(e, cast_i(set1(4503599627370496.0)))), set1(4503599627370496.0 + 1023));
+
+			pd big = gt(m, set1(sqrt2));
+			m = select(big, mul(m, set1(0.5)), m);
+			k = select(big, add(k, set1(1.)), k);
+
+			pd f = sub(m, set1(1.));
+			pd s = div(f, add(set1(2.), f));
+			pd z = mul(s, s);
+			pd R = set1(log_c[0]);
+			for (size_t j = 1; j < sizeof(log_c)/sizeof(*log_c); ++j)
+				R = add(mul(R, z), set1(log_c[j]));
+			R = mul(R, z);
+			pd hfsq = mul(set1(0.5), mul(f, f));
+			pd l = sub(f, sub(hfsq, mul(s, add(hfsq, R))));
+
+			return add(mul(k, set1(ln2_hi)), add(l, mul(k, set1(ln2_lo))));
+		}
+#endif
+
+	} // namespace exp_
+
+	template<class T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, T>::type exp(T x)
+	{
+		return static_cast<T>(exp_::exp(static_cast<double>(x)));
+	}
+	template<class T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, T>::type log(T x)
+	{
+		return static_cast<T>(exp_::log(static_cast<double>(x)));
+	}
+
+	// y[i] = exp(x[i]), i < n. x and y may be the same array.
+	inline void exp(size_t n, const double* x, double* y)
+	{
+		size_t i = 0;
+
+#if defined(NUMERICAL_EXP_AVX2) || defined(NUMERICAL_EXP_SSE2)
+		const exp_::pd lo = exp_::set1(exp_::exp_lo);
+		const exp_::pd hi = exp_::set1(exp_::exp_hi);
+
+		for (; i + exp_::lanes <= n; i += exp_::lanes) {
+			exp_::pd xi = exp_::load(x + i);
+
+			if (exp_::outside(xi, lo, hi)) {
+				for (size_t j = i; j < i + exp_::lanes; ++j)
+					y[j] = exp_::exp(x[j]);
+			}
+			else {
+				exp_::store(y + i, exp_::exp(xi));
+			}
+		}
+#endif
+		for (; i < n; ++i)
+			y[i] = exp_::exp(x[i]);
+	}
+
+	// y[i] = log(x[i]), i < n. x and y may be the same array.
+	inline void log(size_t n, const double* x, double* y)
+	{
+		size_t i = 0;
+
+#if defined(NUMERICAL_EXP_AVX2) || defined(NUMERICAL_EXP_SSE2)
+		const exp_::pd lo = exp_::set1(std::numeric_limits<double>::min());
+		const exp_::pd hi = exp_::set1(std::numeric_limits<double>::max());
+
+		for (; i + exp_::lanes <= n; i += exp_::lanes) {
+			exp_::pd xi = exp_::load(x + i);
+
+			if (exp_::outside(xi, lo, hi)) {
+				for (size_t j = i; j < i + exp_::lanes; ++j)
+					y[j] = exp_::log(x[j]);
+			}
+			else {
+				exp_::store(y + i, exp_::log(xi));
+			}
+		}
+#endif
+		for (; i < n; ++i)
+			y[i] = exp_::log(x[i]);
+	}
+
+	// element-wise exp and log for other types
+	template<class T>
+	inline void exp(size_t n, const T* x, T* y)
+	{
+		using std::exp;
+
+		for (size_t i = 0; i < n; ++i)
+			y[i] = exp(x[i]);
+	}
+	template<class T>
+	inline void log(size_t n, const T* x, T* y)
+	{
+		using std::log;
+
+		for (size_t i = 0; i < n; ++i)
+			y[i] = log(x[i]);
+	}
+
+} // namespace numerical
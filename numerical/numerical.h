@@ -3,6 +3,8 @@
 #pragma once
 
 #include "../include/ensure.h"
+#include "dual.h"
+#include "exp.h"
 #include "newton.h"
 #include "srng.h"
 #include "ulp.h"
\ No newline at end of file
@@ -0,0 +1,64 @@
+// dual_test.cpp - test dual numbers
+#include <cmath>
+#include "../../include/ensure.h"
+#include "../dual.h"
+#include "../newton.h"
+
+using namespace numerical;
+
+template<class T>
+void dual_arithmetic_test_(void)
+{
+	T eps = std::numeric_limits<T>::epsilon();
+
+	// x and y are independent variables
+	dual<T,2> x(2, 0), y(3, 1);
+
+	dual<T,2> z = x*y + x/y - 1;
+	ensure (z.value() == 2*3 + T(2)/3 - 1);
+	ensure (fabs(z[0] - (3 + T(1)/3)) <= eps);
+	ensure (fabs(z[1] - (2 - T(2)/9)) <= 4*eps);
+
+	z = -x + 2*y - y/2;
+	ensure (z[0] == -1);
+	ensure (z[1] == 1.5);
+
+	z = exp(x*y);
+	ensure (fabs(z[0] - 3*::exp(T(6))) <= 4*eps*z.value());
+	ensure (fabs(z[1] - 2*::exp(T(6))) <= 4*eps*z.value());
+
+	z = log(x) + sqrt(y);
+	ensure (fabs(z[0] - T(1)/2) <= eps);
+	ensure (fabs(z[1] - 1/(2*::sqrt(T(3)))) <= eps);
+
+	z = pow(x, T(3));
+	ensure (fabs(z.value() - 8) <= 8*eps);
+	ensure (fabs(z[0] - 12) <= 16*eps);
+	ensure (z[1] == 0);
+
+	ensure (x < y);
+	ensure (x == 2);
+	ensure (x != y);
+	ensure ((dual<T,2>(0) == 0));
+}
+
+template<class T>
+void dual_newton_test_(void)
+{
+	T eps = std::numeric_limits<T>::epsilon();
+
+	// root of x^2 - a is sqrt(a) and d sqrt(a)/da = 1/(2 sqrt(a))
+	dual<T> a(4, 0);
+	auto f = [a](const dual<T>& x) { return x*x - a; };
+	auto df = [](const dual<T>& x) { return 2*x; };
+
+	dual<T> r = root1d::newton(dual<T>(1), f, df, 100);
+	ensure (fabs(r.value() - 2) <= 2*eps);
+	ensure (fabs(r[0] - T(1)/4) <= 2*eps);
+}
+
+void dual_test(void)
+{
+	dual_arithmetic_test_<double>();
+	dual_newton_test_<double>();
+}
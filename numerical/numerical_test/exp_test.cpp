@@ -1,33 +1,101 @@
 // exp_test.cpp - test exponential function
 #include <cmath>
-#include "../../include/timer.h"
+#include <cstdlib>
+#include <vector>
+#include "../../include/ensure.h"
 #include "../exp.h"
+#include "../srng.h"
 #include "../ulp.h"
 
 template<class T>
 void exp_test_(void)
 {
-	utility::timer t;
-
-	t.start();
-	T e = numerical::exp<T>(1);
-	t.stop();
-	double dt = t.elapsed();
-
-	t.start();
-	T e0 = ::exp((T)1);
-	t.stop();
-	dt = t.elapsed();
-
 	for (T t = -10; t <= 10; t += 1) {
 		T e0 = ::exp(t);
 		T e = numerical::exp(t);
-		numerical::ulp_traits<T>::integer i = numerical::ulp(e0, e);
-		ensure (abs(i) < 1e300);
+		typename numerical::ulp_traits<T>::integer i = numerical::ulp(e0, e);
+		ensure (std::abs(i) <= 2);
+	}
+
+	ensure (numerical::exp<T>(0) == 1);
+	ensure (numerical::exp<T>(1000) == std::numeric_limits<T>::infinity());
+	ensure (numerical::exp<T>(-1000) == 0);
+}
+
+template<class T>
+void log_test_(void)
+{
+	for (T t = 1; t <= 1e6; t *= 1.7) {
+		T l0 = ::log(t);
+		T l = numerical::log(t);
+		typename numerical::ulp_traits<T>::integer i = numerical::ulp(l0, l);
+		ensure (std::abs(i) <= 2);
 	}
+
+	ensure (numerical::log<T>(1) == 0);
+	ensure (numerical::log<T>(0) == -std::numeric_limits<T>::infinity());
+	T nan = numerical::log<T>(-1);
+	ensure (nan != nan);
+}
+
+// batch kernels against the C library
+void exp_batch_test(size_t N = 100000)
+{
+	numerical::srng rng(1, 2);
+	std::vector<double> x(N), y(N), z(N);
+
+	for (size_t i = 0; i < N; ++i)
+		x[i] = rng.uniform(-50, 50);
+	// special values
+	x[0] = 0;
+	x[1] = 709.7;
+	x[2] = -740; // subnormal
+	x[3] = 1000;
+	x[4] = -1000;
+	x[5] = std::numeric_limits<double>::quiet_NaN();
+
+	for (size_t i = 0; i < N; ++i)
+		z[i] = ::exp(x[i]);
+	numerical::exp(N, &x[0], &y[0]);
+
+	ensure (y[5] != y[5]);
+	for (size_t i = 0; i < N; ++i) {
+		if (i != 5)
+			ensure (std::abs(numerical::ulp(y[i], z[i])) <= 2);
+	}
+
+	for (size_t i = 0; i < N; ++i)
+		x[i] = ::exp(rng.uniform(-700, 700));
+	x[0] = 1;
+	x[1] = 0;
+	x[2] = -1;
+	x[3] = std::numeric_limits<double>::denorm_min();
+	x[4] = std::numeric_limits<double>::infinity();
+	x[5] = std::numeric_limits<double>::quiet_NaN();
+
+	for (size_t i = 0; i < N; ++i)
+		z[i] = ::log(x[i]);
+	numerical::log(N, &x[0], &y[0]);
+
+	ensure (y[2] != y[2]);
+	ensure (y[5] != y[5]);
+	for (size_t i = 0; i < N; ++i) {
+		if (i != 2 && i != 5)
+			ensure (std::abs(numerical::ulp(y[i], z[i])) <= 2);
+	}
+
+	// in place
+	numerical::exp(N, &x[0], &z[0]);
+	numerical::exp(N, &x[0], &x[0]);
+	for (size_t i = 0; i < N; ++i)
+		ensure (x[i] == z[i] || x[i] != x[i]);
 }
 
 void exp_test(void)
 {
 	exp_test_<double>();
-}
\ No newline at end of file
+	exp_test_<float>();
+	log_test_<double>();
+	log_test_<float>();
+	exp_batch_test();
+}
@@ -1,12 +1,14 @@
 // numerical_test.cpp : main project file.
 #include <iostream>
 
+void dual_test(void);
 void exp_test(void);
 void root1d_newton_test(void);
 
 int main(void)
 {
 	try {
+		dual_test();
 		exp_test();
 		root1d_newton_test();
 	}